@@ -0,0 +1,115 @@
+#include "JBEAxisFilter.h"
+#include "JBEInputBits.h"
+
+#include <cmath>
+
+namespace
+{
+	float InvRange(const AxisFilter & f)
+	{
+		float range = f.outer - f.inner;
+		return 1.0f / ((range > 1e-6f) ? range : 1e-6f);
+	}
+
+#ifdef INPUT_USE_SSE2
+	/*
+	*	\brief	Deadzone, anti deadzone and curve for 4 magnitudes at once
+	*/
+	__m128 Shape(__m128 m, const AxisFilter & f, __m128 inv_range)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 anti = _mm_set1_ps(f.anti_deadzone);
+		const __m128 curve = _mm_set1_ps(f.curve);
+
+		__m128 s = _mm_mul_ps(_mm_sub_ps(m, _mm_set1_ps(f.inner)), inv_range);
+		s = _mm_min_ps(_mm_max_ps(s, zero), one);
+
+		__m128 live = _mm_cmpgt_ps(s, zero);
+		s = _mm_and_ps(live, _mm_add_ps(anti, _mm_mul_ps(_mm_sub_ps(one, anti), s)));
+
+		__m128 cube = _mm_mul_ps(_mm_mul_ps(s, s), s);
+		return _mm_add_ps(s, _mm_mul_ps(curve, _mm_sub_ps(cube, s)));
+	}
+
+	void FilterAxial(float * v, unsigned count, const AxisFilter & f)
+	{
+		const __m128 sign = _mm_set1_ps(-0.0f);
+		const __m128 inv_range = _mm_set1_ps(InvRange(f));
+
+		for (unsigned i = 0; i < count; i += 4)
+		{
+			__m128 x = _mm_loadu_ps(v + i);
+			__m128 shaped = Shape(_mm_andnot_ps(sign, x), f, inv_range);
+			_mm_storeu_ps(v + i, _mm_or_ps(shaped, _mm_and_ps(x, sign)));
+		}
+	}
+#else
+	float Shape(float m, const AxisFilter & f, float inv_range)
+	{
+		float s = (m - f.inner) * inv_range;
+		s = (s < 0.0f) ? 0.0f : (s > 1.0f) ? 1.0f : s;
+
+		if (s > 0.0f)
+			s = f.anti_deadzone + (1.0f - f.anti_deadzone) * s;
+
+		return s + f.curve * (s * s * s - s);
+	}
+
+	void FilterAxial(float * v, unsigned count, const AxisFilter & f)
+	{
+		const float inv_range = InvRange(f);
+
+		for (unsigned i = 0; i < count; ++i)
+		{
+			float shaped = Shape(std::fabs(v[i]), f, inv_range);
+			v[i] = (v[i] < 0.0f) ? -shaped : shaped;
+		}
+	}
+#endif
+}
+
+void FilterSticks(float * x, float * y, unsigned count, const AxisFilter & filter)
+{
+	if (!filter.radial)
+	{
+		FilterAxial(x, count, filter);
+		FilterAxial(y, count, filter);
+		return;
+	}
+
+#ifdef INPUT_USE_SSE2
+	const __m128 inv_range = _mm_set1_ps(InvRange(filter));
+	const __m128 zero = _mm_setzero_ps();
+
+	for (unsigned i = 0; i < count; i += 4)
+	{
+		__m128 vx = _mm_loadu_ps(x + i);
+		__m128 vy = _mm_loadu_ps(y + i);
+		__m128 m = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)));
+
+		//Centered sticks divide 0 by 0, the mask throws that away
+		__m128 scale = _mm_and_ps(_mm_cmpgt_ps(m, zero), _mm_div_ps(Shape(m, filter, inv_range), m));
+
+		_mm_storeu_ps(x + i, _mm_mul_ps(vx, scale));
+		_mm_storeu_ps(y + i, _mm_mul_ps(vy, scale));
+	}
+#else
+	const float inv_range = InvRange(filter);
+
+	for (unsigned i = 0; i < count; ++i)
+	{
+		float m = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+		float scale = (m > 0.0f) ? Shape(m, filter, inv_range) / m : 0.0f;
+
+		x[i] *= scale;
+		y[i] *= scale;
+	}
+#endif
+}
+
+void FilterTriggers(float * t, unsigned count, const AxisFilter & filter)
+{
+	//Triggers never go negative, the axial path keeps them that way
+	FilterAxial(t, count, filter);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+/*
+*	\name	AxisFilter
+*
+*	\brief	Deadzone and response curve settings for analog axes.
+*
+*	\detail	Axes go through these steps, in order:
+*			<li>
+*			deadzone: magnitudes under 'inner' become 0, magnitudes over
+*			'outer' become 1, and everything in between is rescaled to
+*			[0, 1]. Sticks measure the magnitude of the (x, y) vector when
+*			'radial' is set, and each axis on its own otherwise.
+*			anti deadzone: non zero output starts at 'anti_deadzone'
+*			instead of 0, to cancel out a deadzone the game itself has.
+*			response curve: output blends from linear (curve = 0) to cubic
+*			(curve = 1), which gives finer control around the center.
+*			</li>
+*/
+struct AxisFilter
+{
+	bool radial;
+	float inner;
+	float outer;
+	float anti_deadzone;
+	float curve;
+};
+
+/*
+*	\brief	Filters 'count' sticks in place, 'x' and 'y' hold one axis each
+*			(structure of arrays). 'count' must be a multiple of 4.
+*/
+void FilterSticks(float *x, float *y, unsigned count, const AxisFilter &filter);
+
+/*
+*	\brief	Filters 'count' triggers (range [0, 1]) in place. 'count' must
+*			be a multiple of 4. 'radial' is ignored.
+*/
+void FilterTriggers(float *t, unsigned count, const AxisFilter &filter);
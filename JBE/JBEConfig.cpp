@@ -0,0 +1,773 @@
+#include "JBEConfig.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	const char CONFIG_MAGIC[4] = { 'J', 'B', 'E', 'C' };
+
+	//Seeds tried per bucket before the table is made bigger
+	const Uint32 MAX_SEED = 1u << 16;
+
+	/*
+	*	\brief	Integer hash (the murmur3 finalizer), keys are already
+	*			hashes but ones that differ in few bits
+	*/
+	Uint32 Mix(Uint32 h)
+	{
+		h ^= h >> 16;
+		h *= 0x85EBCA6Bu;
+		h ^= h >> 13;
+		h *= 0xC2B2AE35u;
+		h ^= h >> 16;
+		return h;
+	}
+
+	Uint32 BucketOf(Uint32 key, Uint32 bucket_count)
+	{
+		return Mix(key) & (bucket_count - 1);
+	}
+
+	Uint32 SlotOf(Uint32 key, Uint32 seed, Uint32 table_size)
+	{
+		return Mix(key ^ (seed * 0x9E3779B9u)) & (table_size - 1);
+	}
+
+	bool IsPowerOfTwo(Uint32 n)
+	{
+		return n != 0 && (n & (n - 1)) == 0;
+	}
+
+	Uint32 NextPowerOfTwo(Uint32 n)
+	{
+		Uint32 p = 1;
+		while (p < n)
+			p <<= 1;
+		return p;
+	}
+
+	bool Write(SDL_RWops * rw, const void * data, size_t size)
+	{
+		return size == 0 || SDL_RWwrite(rw, data, size, 1) == 1;
+	}
+
+	bool WriteText(SDL_RWops * rw, const char * text)
+	{
+		return Write(rw, text, std::strlen(text));
+	}
+
+	/*
+	*	\brief	Writes 'size' bytes as a quoted, escaped string
+	*/
+	bool WriteQuoted(SDL_RWops * rw, const char * str, size_t size)
+	{
+		std::string out(1, '"');
+
+		for (size_t i = 0; i < size; ++i)
+		{
+			switch (str[i])
+			{
+			case '"': out += "\\\""; break;
+			case '\\': out += "\\\\"; break;
+			case '\n': out += "\\n"; break;
+			case '\t': out += "\\t"; break;
+			default: out += str[i]; break;
+			}
+		}
+
+		out += '"';
+		return Write(rw, out.data(), out.size());
+	}
+
+	bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	int HexDigit(char c)
+	{
+		if (c >= '0' && c <= '9')
+			return c - '0';
+		if (c >= 'a' && c <= 'f')
+			return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F')
+			return c - 'A' + 10;
+		return -1;
+	}
+}
+
+Config::Config() : header_(nullptr), seeds_(nullptr), entries_(nullptr), data_(nullptr),
+	view_(nullptr), view_size_(0),
+#ifdef _WIN32
+	file_(INVALID_HANDLE_VALUE), mapping_(nullptr)
+#else
+	file_(-1)
+#endif
+{
+}
+
+Config::~Config()
+{
+	Close();
+}
+
+bool Config::Open(const char * path)
+{
+	Close();
+
+#ifdef _WIN32
+	file_ = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (file_ == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file_, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(ConfigHeader)))
+	{
+		Close();
+		return false;
+	}
+
+	mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping_ == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	view_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+	view_size_ = static_cast<size_t>(size.QuadPart);
+#else
+	file_ = open(path, O_RDONLY);
+	if (file_ < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(file_, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(ConfigHeader)))
+	{
+		Close();
+		return false;
+	}
+
+	void * view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, file_, 0);
+	if (view != MAP_FAILED)
+	{
+		view_ = view;
+		view_size_ = static_cast<size_t>(st.st_size);
+	}
+#endif
+
+	if (view_ == nullptr || !Attach(view_, view_size_))
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+bool Config::Open(SDL_RWops * rw)
+{
+	Close();
+
+	if (rw == nullptr)
+		return false;
+
+	//One read when the size is known, chunks otherwise
+	const Sint64 start = SDL_RWtell(rw);
+	const Sint64 end = SDL_RWsize(rw);
+
+	if (start >= 0 && end >= start)
+	{
+		buffer_.resize(static_cast<size_t>(end - start));
+		if (!buffer_.empty() && SDL_RWread(rw, buffer_.data(), buffer_.size(), 1) != 1)
+			buffer_.clear();
+	}
+	else
+	{
+		char chunk[4096];
+		size_t read;
+		while ((read = SDL_RWread(rw, chunk, 1, sizeof(chunk))) != 0)
+			buffer_.insert(buffer_.end(), chunk, chunk + read);
+	}
+
+	if (!Attach(buffer_.data(), buffer_.size()))
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void Config::Close()
+{
+#ifdef _WIN32
+	if (view_)
+		UnmapViewOfFile(view_);
+	if (mapping_)
+		CloseHandle(mapping_);
+	if (file_ != INVALID_HANDLE_VALUE)
+		CloseHandle(file_);
+
+	mapping_ = nullptr;
+	file_ = INVALID_HANDLE_VALUE;
+#else
+	if (view_)
+		munmap(const_cast<void *>(view_), view_size_);
+	if (file_ >= 0)
+		close(file_);
+
+	file_ = -1;
+#endif
+
+	view_ = nullptr;
+	view_size_ = 0;
+
+	std::vector<char>().swap(buffer_);
+
+	header_ = nullptr;
+	seeds_ = nullptr;
+	entries_ = nullptr;
+	data_ = nullptr;
+}
+
+unsigned Config::GetCount() const
+{
+	return header_ ? header_->count : 0;
+}
+
+CONFIG_TYPE Config::GetType(Uint32 key) const
+{
+	const ConfigEntry * e = Find(key);
+	return e ? static_cast<CONFIG_TYPE>(e->type) : CONFIG_NONE;
+}
+
+int Config::GetInt(Uint32 key, int fallback) const
+{
+	const ConfigEntry * e = Find(key);
+	return (e && e->type == CONFIG_INT) ? static_cast<int>(static_cast<Sint32>(e->value)) : fallback;
+}
+
+float Config::GetFloat(Uint32 key, float fallback) const
+{
+	const ConfigEntry * e = Find(key);
+	if (e == nullptr)
+		return fallback;
+
+	if (e->type == CONFIG_INT)
+		return static_cast<float>(static_cast<Sint32>(e->value));
+
+	if (e->type != CONFIG_FLOAT)
+		return fallback;
+
+	float value;
+	std::memcpy(&value, &e->value, sizeof(value));
+	return value;
+}
+
+bool Config::GetBool(Uint32 key, bool fallback) const
+{
+	const ConfigEntry * e = Find(key);
+	return (e && e->type == CONFIG_BOOL) ? e->value != 0 : fallback;
+}
+
+const char * Config::GetString(Uint32 key, const char * fallback) const
+{
+	const ConfigEntry * e = Find(key);
+	if (e == nullptr || e->type != CONFIG_STRING)
+		return fallback;
+
+	//Checked with its terminator, so it can be handed out as it is
+	const char * str = Data(e->value, static_cast<Uint64>(e->size) + 1);
+	return (str && str[e->size] == 0) ? str : fallback;
+}
+
+const void * Config::GetBlob(Uint32 key, size_t & size) const
+{
+	const ConfigEntry * e = Find(key);
+	const char * blob = (e && e->type == CONFIG_BLOB) ? Data(e->value, e->size) : nullptr;
+
+	size = blob ? e->size : 0;
+	return blob;
+}
+
+bool Config::ExportText(SDL_RWops * rw) const
+{
+	if (rw == nullptr || header_ == nullptr)
+		return false;
+
+	std::vector<const ConfigEntry *> sorted;
+	for (Uint32 i = 0; i < header_->table_size; ++i)
+		if (entries_[i].type != CONFIG_NONE && Name(entries_[i]))
+			sorted.push_back(&entries_[i]);
+
+	std::sort(sorted.begin(), sorted.end(), [this](const ConfigEntry * a, const ConfigEntry * b)
+	{
+		return std::strcmp(data_ + a->name, data_ + b->name) < 0;
+	});
+
+	for (size_t i = 0; i < sorted.size(); ++i)
+	{
+		const ConfigEntry & e = *sorted[i];
+		char number[64];
+
+		bool ok = WriteText(rw, Name(e)) && WriteText(rw, " = ");
+
+		switch (e.type)
+		{
+		case CONFIG_INT:
+			SDL_snprintf(number, sizeof(number), "%d", static_cast<int>(static_cast<Sint32>(e.value)));
+			ok = ok && WriteText(rw, number);
+			break;
+		case CONFIG_FLOAT:
+		{
+			float value;
+			std::memcpy(&value, &e.value, sizeof(value));
+			SDL_snprintf(number, sizeof(number), "%.9g", value);
+
+			//Keep it a float when it is read back
+			if (std::strpbrk(number, ".eEni") == nullptr)
+				SDL_strlcat(number, ".0", sizeof(number));
+
+			ok = ok && WriteText(rw, number);
+			break;
+		}
+		case CONFIG_BOOL:
+			ok = ok && WriteText(rw, e.value ? "true" : "false");
+			break;
+		case CONFIG_STRING:
+		{
+			const char * str = Data(e.value, e.size);
+			ok = ok && str && WriteQuoted(rw, str, e.size);
+			break;
+		}
+		case CONFIG_BLOB:
+		{
+			const char * blob = Data(e.value, e.size);
+			std::string hex("blob:");
+			static const char DIGITS[] = "0123456789abcdef";
+
+			for (Uint32 b = 0; blob && b < e.size; ++b)
+			{
+				hex += DIGITS[static_cast<Uint8>(blob[b]) >> 4];
+				hex += DIGITS[static_cast<Uint8>(blob[b]) & 15];
+			}
+
+			ok = ok && blob && Write(rw, hex.data(), hex.size());
+			break;
+		}
+		default:
+			break;
+		}
+
+		if (!ok || !WriteText(rw, "\n"))
+			return false;
+	}
+
+	return true;
+}
+
+bool Config::Attach(const void * data, size_t size)
+{
+	if (size < sizeof(ConfigHeader))
+		return false;
+
+	const ConfigHeader * header = static_cast<const ConfigHeader *>(data);
+	if (std::memcmp(header->magic, CONFIG_MAGIC, sizeof(CONFIG_MAGIC)) != 0 ||
+		header->version != CONFIG_VERSION ||
+		header->entry_size != sizeof(ConfigEntry) ||
+		!IsPowerOfTwo(header->bucket_count) ||
+		!IsPowerOfTwo(header->table_size))
+		return false;
+
+	const Uint64 needed = sizeof(ConfigHeader) +
+		static_cast<Uint64>(header->bucket_count) * sizeof(Uint32) +
+		static_cast<Uint64>(header->table_size) * sizeof(ConfigEntry) +
+		header->data_size;
+
+	if (needed > size)
+		return false;
+
+	header_ = header;
+	seeds_ = reinterpret_cast<const Uint32 *>(header + 1);
+	entries_ = reinterpret_cast<const ConfigEntry *>(seeds_ + header->bucket_count);
+	data_ = reinterpret_cast<const char *>(entries_ + header->table_size);
+	return true;
+}
+
+const ConfigEntry * Config::Find(Uint32 key) const
+{
+	if (header_ == nullptr)
+		return nullptr;
+
+	const Uint32 seed = seeds_[BucketOf(key, header_->bucket_count)];
+	const ConfigEntry * e = &entries_[SlotOf(key, seed, header_->table_size)];
+
+	return (e->key == key && e->type != CONFIG_NONE) ? e : nullptr;
+}
+
+const char * Config::Data(Uint64 offset, Uint64 size) const
+{
+	//Both come from 32 bit fields, their sum cannot wrap in 64 bits
+	if (header_ == nullptr || offset + size > header_->data_size)
+		return nullptr;
+
+	return data_ + offset;
+}
+
+const char * Config::Name(const ConfigEntry & e) const
+{
+	const char * name = Data(e.name, 1);
+	if (name == nullptr || std::memchr(name, 0, header_->data_size - e.name) == nullptr)
+		return nullptr;
+
+	return name;
+}
+
+void ConfigWriter::SetInt(const char * name, int value)
+{
+	Set(name, CONFIG_INT).number = static_cast<Uint32>(value);
+}
+
+void ConfigWriter::SetFloat(const char * name, float value)
+{
+	std::memcpy(&Set(name, CONFIG_FLOAT).number, &value, sizeof(value));
+}
+
+void ConfigWriter::SetBool(const char * name, bool value)
+{
+	Set(name, CONFIG_BOOL).number = value ? 1 : 0;
+}
+
+void ConfigWriter::SetString(const char * name, const char * value)
+{
+	Set(name, CONFIG_STRING).data = value ? value : "";
+}
+
+void ConfigWriter::SetBlob(const char * name, const void * data, size_t size)
+{
+	Set(name, CONFIG_BLOB).data.assign(static_cast<const char *>(data), size);
+}
+
+void ConfigWriter::Import(const Config & config)
+{
+	if (config.header_ == nullptr)
+		return;
+
+	for (Uint32 i = 0; i < config.header_->table_size; ++i)
+	{
+		const ConfigEntry & e = config.entries_[i];
+		const char * name = config.Name(e);
+
+		if (e.type == CONFIG_NONE || name == nullptr)
+			continue;
+
+		if (e.type == CONFIG_STRING || e.type == CONFIG_BLOB)
+		{
+			const char * data = config.Data(e.value, e.size);
+			if (data)
+				Set(name, static_cast<CONFIG_TYPE>(e.type)).data.assign(data, e.size);
+		}
+		else if (e.type <= CONFIG_BOOL)
+			Set(name, static_cast<CONFIG_TYPE>(e.type)).number = e.value;
+	}
+}
+
+bool ConfigWriter::ImportText(const char * text, size_t size)
+{
+	const char * end = text + size;
+	unsigned line = 0;
+
+	while (text < end)
+	{
+		const char * eol = static_cast<const char *>(std::memchr(text, '\n', end - text));
+		if (eol == nullptr)
+			eol = end;
+
+		++line;
+		const char * p = text;
+		text = eol + (eol < end ? 1 : 0);
+
+		while (p < eol && IsSpace(*p))
+			++p;
+		if (p == eol || *p == '#')
+			continue;
+
+		const char * eq = static_cast<const char *>(std::memchr(p, '=', eol - p));
+		if (eq == nullptr)
+			return SDL_SetError("Config line %u: expected name = value", line) == 0;
+
+		const char * name_end = eq;
+		while (name_end > p && IsSpace(name_end[-1]))
+			--name_end;
+
+		const char * v = eq + 1;
+		const char * v_end = eol;
+		while (v < v_end && IsSpace(*v))
+			++v;
+		while (v_end > v && IsSpace(v_end[-1]))
+			--v_end;
+
+		if (name_end == p || v == v_end)
+			return SDL_SetError("Config line %u: expected name = value", line) == 0;
+
+		const std::string name(p, name_end);
+		const std::string value(v, v_end);
+
+		if (value[0] == '"')
+		{
+			std::string str;
+			size_t i = 1;
+
+			for (; i < value.size() && value[i] != '"'; ++i)
+			{
+				if (value[i] != '\\' || i + 1 == value.size())
+				{
+					str += value[i];
+					continue;
+				}
+
+				switch (value[++i])
+				{
+				case 'n': str += '\n'; break;
+				case 't': str += '\t'; break;
+				default: str += value[i]; break;
+				}
+			}
+
+			if (i + 1 != value.size())
+				return SDL_SetError("Config line %u: unterminated string", line) == 0;
+
+			Set(name.c_str(), CONFIG_STRING).data = str;
+		}
+		else if (value == "true" || value == "false")
+			SetBool(name.c_str(), value == "true");
+		else if (value.compare(0, 5, "blob:") == 0)
+		{
+			std::string blob;
+
+			for (size_t i = 5; i + 1 < value.size(); i += 2)
+			{
+				const int hi = HexDigit(value[i]);
+				const int lo = HexDigit(value[i + 1]);
+				if (hi < 0 || lo < 0)
+					break;
+
+				blob += static_cast<char>((hi << 4) | lo);
+			}
+
+			if (blob.size() * 2 + 5 != value.size())
+				return SDL_SetError("Config line %u: bad blob", line) == 0;
+
+			SetBlob(name.c_str(), blob.data(), blob.size());
+		}
+		else
+		{
+			char * parsed = nullptr;
+
+			if (value.find_first_of(".eEnN") != std::string::npos)
+			{
+				const double d = std::strtod(value.c_str(), &parsed);
+				if (*parsed == 0)
+				{
+					SetFloat(name.c_str(), static_cast<float>(d));
+					continue;
+				}
+			}
+			else
+			{
+				const long l = std::strtol(value.c_str(), &parsed, 0);
+				if (*parsed == 0)
+				{
+					SetInt(name.c_str(), static_cast<int>(l));
+					continue;
+				}
+			}
+
+			return SDL_SetError("Config line %u: bad value '%s'", line, value.c_str()) == 0;
+		}
+	}
+
+	return true;
+}
+
+unsigned ConfigWriter::GetCount() const
+{
+	return static_cast<unsigned>(values_.size());
+}
+
+void ConfigWriter::Clear()
+{
+	values_.clear();
+}
+
+bool ConfigWriter::Save(const char * path) const
+{
+	SDL_RWops * rw = SDL_RWFromFile(path, "wb");
+	if (rw == nullptr)
+		return false;
+
+	const bool ok = Save(rw);
+	return (SDL_RWclose(rw) == 0) && ok;
+}
+
+bool ConfigWriter::Save(SDL_RWops * rw) const
+{
+	if (rw == nullptr)
+		return false;
+
+	const Uint32 count = static_cast<Uint32>(values_.size());
+
+	//Names were only compared by hash so far
+	std::vector<const Value *> by_key(count);
+	for (Uint32 i = 0; i < count; ++i)
+		by_key[i] = &values_[i];
+
+	std::sort(by_key.begin(), by_key.end(), [](const Value * a, const Value * b) { return a->key < b->key; });
+
+	for (Uint32 i = 1; i < count; ++i)
+		if (by_key[i]->key == by_key[i - 1]->key)
+			return SDL_SetError("Config names '%s' and '%s' have the same hash",
+				by_key[i - 1]->name.c_str(), by_key[i]->name.c_str()) == 0;
+
+	//Hash and displace: about 2 keys per bucket, biggest buckets placed
+	//first while the table is emptiest
+	const Uint32 bucket_count = NextPowerOfTwo(count / 2 + 1);
+	std::vector<std::vector<Uint32>> buckets(bucket_count);
+	for (Uint32 i = 0; i < count; ++i)
+		buckets[BucketOf(values_[i].key, bucket_count)].push_back(i);
+
+	std::vector<Uint32> order(bucket_count);
+	for (Uint32 b = 0; b < bucket_count; ++b)
+		order[b] = b;
+
+	std::stable_sort(order.begin(), order.end(), [&buckets](Uint32 a, Uint32 b) { return buckets[a].size() > buckets[b].size(); });
+
+	Uint32 table_size = NextPowerOfTwo(count + count / 4 + 1);
+	std::vector<Uint32> seeds;
+	std::vector<Sint32> slots;
+
+	for (;;)
+	{
+		seeds.assign(bucket_count, 0);
+		slots.assign(table_size, -1);
+		bool placed = true;
+
+		for (Uint32 o = 0; o < bucket_count && placed; ++o)
+		{
+			const std::vector<Uint32> & bucket = buckets[order[o]];
+			if (bucket.empty())
+				break;
+
+			std::vector<Uint32> taken(bucket.size());
+			placed = false;
+
+			for (Uint32 seed = 0; seed < MAX_SEED && !placed; ++seed)
+			{
+				placed = true;
+
+				//Every key of the bucket in a free slot, and not in the same one
+				for (size_t k = 0; k < bucket.size() && placed; ++k)
+				{
+					taken[k] = SlotOf(values_[bucket[k]].key, seed, table_size);
+					placed = slots[taken[k]] < 0 && std::find(taken.begin(), taken.begin() + k, taken[k]) == taken.begin() + k;
+				}
+
+				if (placed)
+				{
+					for (size_t k = 0; k < bucket.size(); ++k)
+						slots[taken[k]] = static_cast<Sint32>(bucket[k]);
+					seeds[order[o]] = seed;
+				}
+			}
+		}
+
+		if (placed)
+			break;
+
+		table_size *= 2;
+	}
+
+	//Names, then strings and blobs, each string null terminated
+	std::string data;
+	std::vector<ConfigEntry> entries(table_size);
+
+	for (Uint32 s = 0; s < table_size; ++s)
+	{
+		ConfigEntry & e = entries[s];
+		std::memset(&e, 0, sizeof(e));
+		e.type = CONFIG_NONE;
+
+		if (slots[s] < 0)
+			continue;
+
+		const Value & v = values_[slots[s]];
+		e.key = v.key;
+		e.type = v.type;
+		e.name = static_cast<Uint32>(data.size());
+		data.append(v.name.c_str(), v.name.size() + 1);
+
+		if (v.type == CONFIG_STRING || v.type == CONFIG_BLOB)
+		{
+			e.value = static_cast<Uint32>(data.size());
+			e.size = static_cast<Uint32>(v.data.size());
+			data.append(v.data.data(), v.data.size());
+			data += '\0';
+		}
+		else
+			e.value = v.number;
+	}
+
+	ConfigHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, CONFIG_MAGIC, sizeof(CONFIG_MAGIC));
+	header.version = CONFIG_VERSION;
+	header.count = count;
+	header.bucket_count = bucket_count;
+	header.table_size = table_size;
+	header.data_size = static_cast<Uint32>(data.size());
+	header.entry_size = sizeof(ConfigEntry);
+
+	return Write(rw, &header, sizeof(header)) &&
+		Write(rw, seeds.data(), seeds.size() * sizeof(Uint32)) &&
+		Write(rw, entries.data(), entries.size() * sizeof(ConfigEntry)) &&
+		Write(rw, data.data(), data.size());
+}
+
+ConfigWriter::Value & ConfigWriter::Set(const char * name, CONFIG_TYPE type)
+{
+	const Uint32 key = JBEHash(name);
+
+	for (size_t i = 0; i < values_.size(); ++i)
+	{
+		if (values_[i].key == key && values_[i].name == name)
+		{
+			values_[i].type = type;
+			values_[i].data.clear();
+			return values_[i];
+		}
+	}
+
+	Value v;
+	v.name = name;
+	v.key = key;
+	v.type = type;
+	v.number = 0;
+	values_.push_back(v);
+	return values_.back();
+}
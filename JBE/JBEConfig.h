@@ -0,0 +1,256 @@
+#pragma once
+#define CONFIG_VERSION 1
+
+#include "JBEHash.h"
+
+#include <SDL.h>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+*	\brief	Compile time key for the setting called 'name', e.g.
+*			CONFIG_KEY("video.width"). The string is hashed by the compiler.
+*/
+#define CONFIG_KEY(name) (std::integral_constant<Uint32, JBEHash(name)>::value)
+
+enum CONFIG_TYPE : Uint32
+{
+	CONFIG_INT,
+	CONFIG_FLOAT,
+	CONFIG_BOOL,
+	CONFIG_STRING,
+	CONFIG_BLOB,
+
+	CONFIG_NONE = 0xFF	//empty table entry
+};
+
+/*
+*	\brief	Header at the start of every config file. The file goes on
+*			with 'bucket_count' Uint32 seeds, 'table_size' ConfigEntry and
+*			'data_size' bytes of names, strings and blobs, in the byte
+*			order of the machine that wrote them.
+*/
+struct ConfigHeader
+{
+	char magic[4];			//'J','B','E','C'
+	Uint32 version;			//CONFIG_VERSION
+	Uint32 count;			//settings stored
+	Uint32 bucket_count;	//power of two
+	Uint32 table_size;		//power of two
+	Uint32 data_size;
+	Uint32 entry_size;		//sizeof(ConfigEntry)
+	Uint32 reserved;
+};
+
+/*
+*	\brief	One setting. 'name' is an offset into the data, 'value' is
+*			the value itself for numbers and an offset for strings (null
+*			terminated, 'size' bytes without it) and blobs.
+*/
+struct ConfigEntry
+{
+	Uint32 key;		//JBEHash of the name
+	Uint32 type;	//CONFIG_TYPE
+	Uint32 name;
+	Uint32 value;
+	Uint32 size;
+};
+
+/*
+*	\name	Config
+*
+*	\brief	Read only settings, loaded from a file written by ConfigWriter.
+*
+*	\detail	Nothing is parsed at load: the file is memory mapped (or read
+*			in one go from a SDL_RWops) and used in place. Keys are
+*			JBEHash values, usually from CONFIG_KEY, and are found through
+*			a perfect hash built when the file was written: the key picks
+*			a bucket, the bucket's seed picks the one entry the key can be
+*			in, and comparing the 32 bit key stored there settles it. A
+*			lookup is two integer hashes and two loads, whatever the size
+*			of the file, with no string ever compared.
+*/
+class Config
+{
+public:
+	Config();
+	~Config();
+
+	Config(const Config &) = delete;
+	Config & operator=(const Config &) = delete;
+
+	/*
+	*	\brief	Maps the config at 'path' and validates its header
+	*
+	*	\retval	true	The settings can be read.
+	*	\retval	false	The file is missing, unreadable or not a config
+	*					this build can read.
+	*/
+	bool Open(const char *path);
+
+	/*
+	*	\brief	Reads the whole of 'rw' (from its current position) into
+	*			one buffer, for configs that are not plain files. 'rw' is
+	*			left open. See Open.
+	*/
+	bool Open(SDL_RWops *rw);
+
+	/*
+	*	\brief	Unmaps or frees the config, every setting reads as missing
+	*/
+	void Close();
+
+	/*
+	*	\brief	Returns how many settings the config has
+	*/
+	unsigned GetCount() const;
+
+	/*
+	*	\brief	Returns the type of the setting 'key', CONFIG_NONE if the
+	*			config has none
+	*/
+	CONFIG_TYPE GetType(Uint32 key) const;
+
+	/*
+	*	\brief	Typed reads, 'fallback' when the setting is missing or of
+	*			another type. Ints read as floats too.
+	*/
+	int GetInt(Uint32 key, int fallback = 0) const;
+	float GetFloat(Uint32 key, float fallback = 0.0f) const;
+	bool GetBool(Uint32 key, bool fallback = false) const;
+	const char * GetString(Uint32 key, const char *fallback = "") const;
+
+	/*
+	*	\brief	Returns the blob 'key' and sets 'size' to its length, or
+	*			nullptr if there is none. Blobs are only byte aligned.
+	*/
+	const void * GetBlob(Uint32 key, size_t &size) const;
+
+	/*
+	*	\brief	Writes every setting to 'rw' as text, one "name = value"
+	*			per line sorted by name, which ConfigWriter::ImportText
+	*			reads back
+	*/
+	bool ExportText(SDL_RWops *rw) const;
+
+private:
+	friend class ConfigWriter;
+
+	/*
+	*	\brief	Points the tables into 'data' after checking the header and
+	*			that every table fits. Entries are not read here, each one
+	*			is bounds checked when it is used.
+	*/
+	bool Attach(const void *data, size_t size);
+
+	const ConfigEntry * Find(Uint32 key) const;
+
+	/*
+	*	\brief	Returns the 'size' bytes at 'offset' of the data, or nullptr
+	*			if they run past it
+	*/
+	const char * Data(Uint64 offset, Uint64 size) const;
+
+	/*
+	*	\brief	Returns the name of 'e', or nullptr if it is not null
+	*			terminated inside the data
+	*/
+	const char * Name(const ConfigEntry &e) const;
+
+	const ConfigHeader *header_;
+	const Uint32 *seeds_;
+	const ConfigEntry *entries_;
+	const char *data_;
+
+	std::vector<char> buffer_;	//only for configs read from a SDL_RWops
+
+	const void *view_;
+	size_t view_size_;
+#ifdef _WIN32
+	void *file_;
+	void *mapping_;
+#else
+	int file_;
+#endif
+};
+
+/*
+*	\name	ConfigWriter
+*
+*	\brief	Collects settings and writes them as a file Config can load,
+*			building its perfect hash.
+*
+*	\detail	Meant for tools and for saving settings, not for the frame:
+*			it allocates freely. Two names with the same JBEHash cannot be
+*			stored together, Save fails and names them in SDL_GetError.
+*/
+class ConfigWriter
+{
+public:
+	/*
+	*	\brief	Sets the setting 'name', replacing it if it was already set
+	*/
+	void SetInt(const char *name, int value);
+	void SetFloat(const char *name, float value);
+	void SetBool(const char *name, bool value);
+	void SetString(const char *name, const char *value);
+	void SetBlob(const char *name, const void *data, size_t size);
+
+	/*
+	*	\brief	Copies every setting of 'config' in
+	*/
+	void Import(const Config &config);
+
+	/*
+	*	\name	ImportText
+	*
+	*	\brief	Parses 'size' bytes of text in the format of
+	*			Config::ExportText and sets every setting in it.
+	*
+	*	\detail	One "name = value" per line, '#' starts a comment. Values
+	*			are true or false, integers, numbers with a '.' or an
+	*			exponent, "quoted strings" (with \" \\ \n and \t escapes)
+	*			and blob:<hex bytes>.
+	*
+	*	\retval	true	Every line was read.
+	*	\retval false	A line is malformed, SDL_GetError says which. The
+	*					lines before it were set.
+	*/
+	bool ImportText(const char *text, size_t size);
+
+	/*
+	*	\brief	Returns how many settings are set
+	*/
+	unsigned GetCount() const;
+
+	/*
+	*	\brief	Forgets every setting
+	*/
+	void Clear();
+
+	/*
+	*	\brief	Writes the settings to 'path' or 'rw' (left open)
+	*
+	*	\retval	true	The config was written.
+	*	\retval	false	Writing failed or two names collide, see
+	*					SDL_GetError.
+	*/
+	bool Save(const char *path) const;
+	bool Save(SDL_RWops *rw) const;
+
+private:
+	struct Value
+	{
+		std::string name;
+		Uint32 key;
+		CONFIG_TYPE type;
+		Uint32 number;		//int, float bits or bool
+		std::string data;	//string or blob
+	};
+
+	Value & Set(const char *name, CONFIG_TYPE type);
+
+	std::vector<Value> values_;
+};
@@ -0,0 +1,151 @@
+#pragma once
+#define DELEGATE_BUFFER_SIZE (sizeof(void *) * 4)
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+*	\name	Delegate
+*
+*	\brief	Callable with signature 'Signature' stored in place.
+*
+*	\detail	Like std::function, but the callable (a function pointer, or
+*			a lambda capturing up to DELEGATE_BUFFER_SIZE bytes, e.g. an
+*			object pointer and a couple of values) always lives inside the
+*			delegate, so making, copying and calling one never allocates.
+*			Bigger callables do not compile, capture a pointer to the
+*			state instead. Calling an empty delegate does nothing.
+*/
+template <typename Signature>
+class Delegate;
+
+template <typename R, typename... Args>
+class Delegate<R(Args...)>
+{
+public:
+	Delegate() : invoke_(nullptr), manage_(nullptr) {}
+
+	template <typename F, typename = typename std::enable_if<
+		!std::is_same<typename std::decay<F>::type, Delegate>::value>::type>
+	Delegate(F &&f)
+	{
+		typedef typename std::decay<F>::type T;
+		static_assert(sizeof(T) <= DELEGATE_BUFFER_SIZE, "Delegate callable is too big, capture less");
+		static_assert(alignof(T) <= alignof(Storage), "Delegate callable is over aligned");
+
+		new (&buffer_) T(std::forward<F>(f));
+		invoke_ = &Invoke<T>;
+		manage_ = &Manage<T>;
+	}
+
+	Delegate(const Delegate & other) : invoke_(nullptr), manage_(nullptr)
+	{
+		Assign(other, COPY);
+	}
+
+	Delegate(Delegate && other) : invoke_(nullptr), manage_(nullptr)
+	{
+		Assign(other, MOVE);
+	}
+
+	~Delegate()
+	{
+		Reset();
+	}
+
+	Delegate & operator=(const Delegate & other)
+	{
+		if (this != &other)
+		{
+			Reset();
+			Assign(other, COPY);
+		}
+
+		return *this;
+	}
+
+	Delegate & operator=(Delegate && other)
+	{
+		if (this != &other)
+		{
+			Reset();
+			Assign(other, MOVE);
+		}
+
+		return *this;
+	}
+
+	/*
+	*	\brief	Destroys the callable, leaving the delegate empty
+	*/
+	void Reset()
+	{
+		if (manage_)
+			manage_(DESTROY, &buffer_, nullptr);
+
+		invoke_ = nullptr;
+		manage_ = nullptr;
+	}
+
+	explicit operator bool() const
+	{
+		return invoke_ != nullptr;
+	}
+
+	R operator()(Args... args) const
+	{
+		if (invoke_ == nullptr)
+			return R();
+
+		return invoke_(const_cast<Storage *>(&buffer_), std::forward<Args>(args)...);
+	}
+
+private:
+	enum OPERATION
+	{
+		COPY,
+		MOVE,
+		DESTROY
+	};
+
+	typedef typename std::aligned_storage<DELEGATE_BUFFER_SIZE, alignof(std::max_align_t)>::type Storage;
+
+	template <typename T>
+	static R Invoke(void * buffer, Args... args)
+	{
+		return (*static_cast<T *>(buffer))(std::forward<Args>(args)...);
+	}
+
+	template <typename T>
+	static void Manage(OPERATION op, void * dst, void * src)
+	{
+		switch (op)
+		{
+		case COPY:
+			new (dst) T(*static_cast<const T *>(src));
+			break;
+		case MOVE:
+			new (dst) T(std::move(*static_cast<T *>(src)));
+			break;
+		case DESTROY:
+			static_cast<T *>(dst)->~T();
+			break;
+		}
+	}
+
+	void Assign(const Delegate & other, OPERATION op)
+	{
+		if (other.manage_ == nullptr)
+			return;
+
+		other.manage_(op, &buffer_, const_cast<Storage *>(&other.buffer_));
+		invoke_ = other.invoke_;
+		manage_ = other.manage_;
+	}
+
+	Storage buffer_;
+	R (*invoke_)(void *, Args...);
+	void (*manage_)(OPERATION, void *, void *);
+};
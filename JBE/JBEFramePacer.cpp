@@ -0,0 +1,185 @@
+#include "JBEFramePacer.h"
+#include "JBEWindow.h"
+
+#include <cmath>
+
+//Static vars
+Uint64 FramePacer::freq_ = 1;
+double FramePacer::rate_ = 0.0;
+Uint64 FramePacer::period_ = 0;
+Uint64 FramePacer::deadline_ = 0;
+Uint64 FramePacer::last_ = 0;
+Uint64 FramePacer::margin_ = 0;
+bool FramePacer::vsync_ = false;
+Uint64 FramePacer::refresh_ = 0;
+FramePacer::Frame FramePacer::frames_[FRAME_PACER_HISTORY];
+Uint64 FramePacer::count_ = 0;
+FramePacer::Stats FramePacer::stats_;
+
+namespace
+{
+	Uint64 SecondsToTicks(double seconds, Uint64 freq)
+	{
+		return static_cast<Uint64>(seconds * static_cast<double>(freq));
+	}
+}
+
+void FramePacer::Init(double rate)
+{
+	freq_ = SDL_GetPerformanceFrequency();
+	margin_ = SecondsToTicks(FRAME_PACER_SPIN_MIN, freq_);
+	count_ = 0;
+	stats_ = Stats();
+
+	last_ = SDL_GetPerformanceCounter();
+	SetTargetRate(rate);
+}
+
+void FramePacer::SetTargetRate(double rate)
+{
+	rate_ = (rate > 0.0) ? rate : 0.0;
+	period_ = (rate_ > 0.0) ? SecondsToTicks(1.0 / rate_, freq_) : 0;
+
+	//Start the schedule over from the current frame
+	deadline_ = last_;
+}
+
+double FramePacer::GetTargetRate()
+{
+	return rate_;
+}
+
+void FramePacer::SetVSync(bool vsync)
+{
+	vsync_ = vsync;
+	refresh_ = 0;
+
+	if (!vsync)
+		return;
+
+	SDL_Window * window = WindowManager::GetWindowHandle();
+	const int display = window ? SDL_GetWindowDisplayIndex(window) : 0;
+
+	SDL_DisplayMode mode;
+	if (display >= 0 && SDL_GetCurrentDisplayMode(display, &mode) == 0 && mode.refresh_rate > 0)
+		refresh_ = freq_ / static_cast<Uint64>(mode.refresh_rate);
+}
+
+void FramePacer::Wait()
+{
+	Uint64 now = SDL_GetPerformanceCounter();
+	Frame & frame = frames_[count_ % FRAME_PACER_HISTORY];
+	frame.slept = frame.spun = 0;
+	frame.late = false;
+
+	if (period_ == 0 || IsSwapPaced())
+		deadline_ = now;
+	else
+	{
+		deadline_ += period_;
+
+		if (now < deadline_ && deadline_ - now > margin_)
+		{
+			//Sleep what surely is not overslept, whole milliseconds only
+			const Uint32 ms = static_cast<Uint32>((deadline_ - now - margin_) * 1000 / freq_);
+
+			if (ms != 0)
+			{
+				SDL_Delay(ms);
+
+				const Uint64 woke = SDL_GetPerformanceCounter();
+				const Uint64 asked = static_cast<Uint64>(ms) * freq_ / 1000;
+				const Uint64 over = (woke - now > asked) ? woke - now - asked : 0;
+
+				//Jump up to a late wake up at once, come back down slowly
+				if (over > margin_)
+					margin_ = over;
+				else
+					margin_ -= (margin_ - over) / 64;
+
+				const Uint64 lo = SecondsToTicks(FRAME_PACER_SPIN_MIN, freq_);
+				const Uint64 hi = SecondsToTicks(FRAME_PACER_SPIN_MAX, freq_);
+				margin_ = (margin_ < lo) ? lo : (margin_ > hi) ? hi : margin_;
+
+				frame.slept = woke - now;
+				now = woke;
+			}
+		}
+
+		if (now < deadline_)
+		{
+			const Uint64 start = now;
+			while (now < deadline_)
+				now = SDL_GetPerformanceCounter();
+
+			frame.spun = now - start;
+		}
+		else
+		{
+			frame.late = now > deadline_;
+
+			if (now - deadline_ > period_)
+				deadline_ = now;
+		}
+	}
+
+	frame.duration = now - last_;
+	last_ = now;
+	++count_;
+}
+
+double FramePacer::GetFrameTime()
+{
+	if (count_ == 0)
+		return 0.0;
+
+	return static_cast<double>(frames_[(count_ - 1) % FRAME_PACER_HISTORY].duration) / freq_;
+}
+
+const FramePacer::Stats & FramePacer::GetStats()
+{
+	stats_ = Stats();
+	stats_.frames = static_cast<unsigned>((count_ < FRAME_PACER_HISTORY) ? count_ : FRAME_PACER_HISTORY);
+
+	if (stats_.frames == 0)
+		return stats_;
+
+	Uint64 total = 0, slept = 0, spun = 0;
+	Uint64 lo = frames_[0].duration, hi = frames_[0].duration;
+
+	for (unsigned i = 0; i < stats_.frames; ++i)
+	{
+		const Frame & f = frames_[i];
+		total += f.duration;
+		slept += f.slept;
+		spun += f.spun;
+		stats_.late += f.late ? 1 : 0;
+		lo = (f.duration < lo) ? f.duration : lo;
+		hi = (f.duration > hi) ? f.duration : hi;
+	}
+
+	const double freq = static_cast<double>(freq_);
+	const double n = static_cast<double>(stats_.frames);
+
+	stats_.mean = total / freq / n;
+	stats_.min = lo / freq;
+	stats_.max = hi / freq;
+	stats_.sleep = slept / freq / n;
+	stats_.spin = spun / freq / n;
+
+	double variance = 0.0;
+	for (unsigned i = 0; i < stats_.frames; ++i)
+	{
+		const double d = frames_[i].duration / freq - stats_.mean;
+		variance += d * d;
+	}
+
+	stats_.jitter = std::sqrt(variance / n);
+	return stats_;
+}
+
+bool FramePacer::IsSwapPaced()
+{
+	//Unknown refresh rate, assume the swap is the slower of the two
+	return vsync_ && (refresh_ == 0 || period_ <= refresh_);
+}
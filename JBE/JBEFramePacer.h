@@ -0,0 +1,124 @@
+#pragma once
+#define FRAME_PACER_RATE 60.0
+#define FRAME_PACER_HISTORY 128
+#define FRAME_PACER_SPIN_MIN 0.0005
+#define FRAME_PACER_SPIN_MAX 0.004
+
+#include <SDL.h>
+
+/*
+*	\name	FramePacer
+*
+*	\brief	Holds the main loop to a target frame rate without burning a
+*			core, and measures how evenly frames come out.
+*
+*	\detail	Wait, called once at the end of every frame, sleeps with
+*			SDL_Delay until shortly before the frame is due and spins on
+*			SDL_GetPerformanceCounter for the rest, since the OS may wake
+*			a sleeping thread a millisecond or more late. How long it
+*			spins adapts to how late SDL_Delay has been waking up,
+*			between FRAME_PACER_SPIN_MIN and FRAME_PACER_SPIN_MAX
+*			seconds, so most of the wait is spent asleep. Deadlines are
+*			kept on a fixed schedule, a frame that runs a little long is
+*			made up by the next one, and after a frame more than a whole
+*			period late the schedule starts over instead of rushing to
+*			catch up.
+*/
+class FramePacer
+{
+public:
+	/*
+	*	\brief	Frame time figures over the last FRAME_PACER_HISTORY frames,
+	*			in seconds
+	*/
+	struct Stats
+	{
+		unsigned frames;	//frames the figures cover
+		unsigned late;		//frames that ended past their deadline
+		double mean;
+		double jitter;		//standard deviation of the frame time
+		double min;
+		double max;
+		double sleep;		//time spent in SDL_Delay, per frame
+		double spin;		//time spent spinning, per frame
+	};
+
+	/*
+	*	\brief	Forgets every frame measured and starts pacing at 'rate'
+	*			frames per second from now. See SetTargetRate.
+	*/
+	static void Init(double rate = FRAME_PACER_RATE);
+
+	/*
+	*	\brief	Paces frames at 'rate' per second, 0 (or less) only
+	*			measures them
+	*/
+	static void SetTargetRate(double rate);
+
+	/*
+	*	\brief	Returns the rate set with SetTargetRate
+	*/
+	static double GetTargetRate();
+
+	/*
+	*	\name	SetVSync
+	*
+	*	\brief	Tells the pacer whether presenting a frame waits for the
+	*			vertical blank.
+	*
+	*	\detail	With vsync on, the swap already holds the loop to the
+	*			refresh rate of the display the window is on, so Wait only
+	*			measures frames unless the target rate is lower than it.
+	*			Call it again after the window moves to another display.
+	*/
+	static void SetVSync(bool vsync);
+
+	/*
+	*	\brief	Waits until the current frame is due, then starts the next
+	*			one. Call it once per frame, after the frame's work.
+	*/
+	static void Wait();
+
+	/*
+	*	\brief	Returns how long the last frame took, wait included, in
+	*			seconds
+	*/
+	static double GetFrameTime();
+
+	/*
+	*	\brief	Returns the frame time figures of the last frames
+	*/
+	static const Stats & GetStats();
+
+private:
+	/*
+	*	\brief	Whether Wait leaves the pacing to the swap, see SetVSync
+	*/
+	static bool IsSwapPaced();
+
+	static Uint64 freq_;
+	static double rate_;
+	static Uint64 period_;		//counter ticks per frame, 0 for no pacing
+	static Uint64 deadline_;	//counter value the current frame is due at
+	static Uint64 last_;		//counter value the current frame started at
+	static Uint64 margin_;		//counter ticks spun before each deadline
+
+	static bool vsync_;
+	static Uint64 refresh_;	//counter ticks per refresh, 0 if unknown
+
+	/*
+	*	\brief	Ring of the last frames, frame 'n' at 'n % FRAME_PACER_HISTORY'
+	*/
+	struct Frame
+	{
+		Uint64 duration;
+		Uint64 slept;
+		Uint64 spun;
+		bool late;
+	};
+
+	static Frame frames_[FRAME_PACER_HISTORY];
+	static Uint64 count_;
+
+	static Stats stats_;
+};
@@ -0,0 +1,235 @@
+#include "JBEHaptics.h"
+#include "JBEInput.h"
+
+//Static vars
+bool Haptics::enabled_ = false;
+SPSCQueue<Haptics::Request, HAPTICS_QUEUE_SIZE> Haptics::queue_;
+std::atomic<unsigned> Haptics::dropped_(0);
+std::vector<Haptics::Device> Haptics::devices_;
+Haptics::Stats Haptics::stats_;
+
+namespace
+{
+	const Uint8 STOP_PRIORITY = 0xFF;
+
+	/*
+	*	\brief	Whether the tick 'a' comes after 'b', SDL_GetTicks wraps
+	*			after 49 days
+	*/
+	bool After(Uint32 a, Uint32 b)
+	{
+		return static_cast<Sint32>(a - b) > 0;
+	}
+}
+
+bool Haptics::Init()
+{
+	Request req;
+	while (queue_.Pop(req))
+		;
+
+	dropped_.store(0, std::memory_order_relaxed);
+	devices_.clear();
+	stats_ = Stats();
+
+	enabled_ = SDL_InitSubSystem(SDL_INIT_HAPTIC) == 0;
+	return enabled_;
+}
+
+void Haptics::Shutdown()
+{
+	const Uint32 now = SDL_GetTicks();
+
+	for (unsigned i = 0; i < devices_.size(); ++i)
+	{
+		Device & dev = devices_[i];
+		if (dev.haptic && dev.playing.active && After(dev.playing.until, now))
+			SDL_HapticRumbleStop(dev.haptic);
+
+		Close(dev);
+	}
+
+	devices_.clear();
+
+	if (enabled_)
+		SDL_QuitSubSystem(SDL_INIT_HAPTIC);
+	enabled_ = false;
+}
+
+bool Haptics::Rumble(unsigned which, float strength, Uint32 duration, Uint8 priority)
+{
+	return Push(which, strength, duration, priority);
+}
+
+bool Haptics::Stop(unsigned which)
+{
+	return Push(which, 0.0f, 0, STOP_PRIORITY);
+}
+
+bool Haptics::Push(unsigned which, float strength, Uint32 duration, Uint8 priority)
+{
+	Request req;
+	req.id = Input::GetControllerID(which);
+	req.strength = (strength < 0.0f) ? 0.0f : (strength > 1.0f) ? 1.0f : strength;
+	req.duration = duration;
+	req.priority = priority;
+
+	if (req.id < 0)
+		return false;
+
+	if (!queue_.Push(req))
+	{
+		dropped_.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	return true;
+}
+
+void Haptics::Flush()
+{
+	stats_ = Stats();
+	const Uint32 now = SDL_GetTicks();
+
+	Request req;
+	while (queue_.Pop(req))
+	{
+		++stats_.requests;
+
+		if (!enabled_)
+			continue;
+
+		Device * dev = FindDevice(req.id);
+		if (dev)
+			Merge(*dev, req, now);
+	}
+
+	for (unsigned i = 0; i < devices_.size();)
+	{
+		//Unplugged, SDL has closed the controller already
+		if (Input::GetControllerHandle(devices_[i].id) == nullptr)
+		{
+			Close(devices_[i]);
+			devices_[i] = devices_.back();
+			devices_.pop_back();
+			continue;
+		}
+
+		Play(devices_[i], now);
+		++i;
+	}
+}
+
+const Haptics::Stats & Haptics::GetStats()
+{
+	return stats_;
+}
+
+unsigned Haptics::GetDroppedRequests()
+{
+	return dropped_.load(std::memory_order_relaxed);
+}
+
+Haptics::Device * Haptics::FindDevice(SDL_JoystickID id)
+{
+	for (unsigned i = 0; i < devices_.size(); ++i)
+		if (devices_[i].id == id)
+			return &devices_[i];
+
+	SDL_GameController * gc = Input::GetControllerHandle(id);
+	if (gc == nullptr)
+		return nullptr;
+
+	SDL_Haptic * haptic = SDL_HapticOpenFromJoystick(SDL_GameControllerGetJoystick(gc));
+	if (haptic && (SDL_HapticRumbleSupported(haptic) != SDL_TRUE || SDL_HapticRumbleInit(haptic) != 0))
+	{
+		SDL_HapticClose(haptic);
+		haptic = nullptr;
+	}
+
+	Device dev;
+	dev.id = id;
+	dev.haptic = haptic;
+	dev.playing = dev.pending = Effect();
+	dev.last_call = 0;
+
+	devices_.push_back(dev);
+	return &devices_.back();
+}
+
+void Haptics::Merge(Device & dev, const Request & req, Uint32 now)
+{
+	Effect e;
+	e.strength = req.strength;
+	e.until = now + req.duration;
+	e.priority = req.priority;
+	e.active = true;
+
+	Effect & p = dev.pending;
+
+	if (!p.active || e.priority > p.priority)
+		p = e;
+	else if (e.priority == p.priority)
+	{
+		if (e.strength > p.strength)
+			p.strength = e.strength;
+		if (After(e.until, p.until))
+			p.until = e.until;
+	}
+}
+
+void Haptics::Play(Device & dev, Uint32 now)
+{
+	Effect & p = dev.pending;
+	Effect & cur = dev.playing;
+
+	if (!p.active)
+		return;
+
+	if (dev.haptic == nullptr)
+	{
+		p.active = false;
+		return;
+	}
+
+	const bool playing = cur.active && After(cur.until, now);
+	const bool stop = p.strength <= 0.0f;
+
+	//Covered by what is playing, or nothing left to do
+	if ((playing && p.priority < cur.priority) ||
+		(playing && !stop && p.priority == cur.priority && p.strength <= cur.strength && !After(p.until, cur.until)) ||
+		(!stop && !After(p.until, now)) ||
+		(stop && !playing))
+	{
+		p.active = false;
+		++stats_.skipped;
+		return;
+	}
+
+	//Too soon for this device, unless it overrides the effect playing
+	if (now - dev.last_call < HAPTICS_MIN_INTERVAL && !stop && !(playing && p.priority > cur.priority))
+	{
+		++stats_.delayed;
+		return;
+	}
+
+	if (stop)
+		SDL_HapticRumbleStop(dev.haptic);
+	else
+		SDL_HapticRumblePlay(dev.haptic, p.strength, p.until - now);
+
+	++stats_.calls;
+	dev.last_call = now;
+
+	cur = p;
+	cur.active = !stop;
+	p.active = false;
+}
+
+void Haptics::Close(Device & dev)
+{
+	if (dev.haptic)
+		SDL_HapticClose(dev.haptic);
+
+	dev.haptic = nullptr;
+}
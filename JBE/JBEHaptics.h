@@ -0,0 +1,173 @@
+#pragma once
+#define HAPTICS_QUEUE_SIZE 256
+#define HAPTICS_MIN_INTERVAL 50
+
+#include "JBEInputQueue.h"
+
+#include <SDL.h>
+#include <atomic>
+#include <vector>
+
+/*
+*	\name	Haptics
+*
+*	\brief	Rumble for the controllers Input tracks.
+*
+*	\detail	Every call into SDL_Haptic goes down to the driver and can
+*			take a good part of a millisecond, so gameplay never calls
+*			it directly. Rumble only queues a request, and Flush, once per
+*			frame, merges every request of each controller into one,
+*			drops the ones the effect already playing covers and only
+*			then talks to SDL, at most once per controller and at most
+*			once every HAPTICS_MIN_INTERVAL ms unless a request of higher
+*			priority comes in.
+*/
+class Haptics
+{
+public:
+	/*
+	*	\brief	Counters of the last Flush
+	*/
+	struct Stats
+	{
+		unsigned requests;	//requests taken from the queue
+		unsigned calls;		//calls made to SDL_Haptic
+		unsigned skipped;	//requests dropped because the playing effect covered them
+		unsigned delayed;	//merged requests held back by HAPTICS_MIN_INTERVAL
+	};
+
+	/*
+	*	\brief	Starts the SDL haptic subsystem and clears the queue
+	*
+	*	\retval	true	Haptics are available.
+	*	\retval false	SDL has no haptic support here, requests are
+	*					still taken and thrown away by Flush.
+	*/
+	static bool Init();
+
+	/*
+	*	\brief	Stops every effect and closes every haptic device
+	*/
+	static void Shutdown();
+
+	/*
+	*	\name	Rumble
+	*
+	*	\brief	Asks the controller 'which' (the slot every Input GamePad
+	*			function takes) to rumble at 'strength' (0 to 1) for
+	*			'duration' ms.
+	*
+	*	\detail	Of the requests of one frame, the one with the highest
+	*			'priority' wins, requests of the same priority merge into
+	*			the strongest and longest of them. A request of lower
+	*			priority than the effect playing is ignored until it ends.
+	*			Call it from the thread running Input::Update, the
+	*			controller is resolved there.
+	*
+	*	\retval	true	The request was queued.
+	*	\retval false	Nothing is plugged into 'which' or the queue is full.
+	*/
+	static bool Rumble(unsigned which, float strength, Uint32 duration, Uint8 priority = 0);
+
+	/*
+	*	\brief	Stops the rumble of the controller 'which', whatever its
+	*			priority. See Rumble.
+	*/
+	static bool Stop(unsigned which);
+
+	/*
+	*	\name	Flush
+	*
+	*	\brief	Sends the requests queued since the last Flush to SDL.
+	*
+	*	\detail	Call it once per frame from the thread pumping SDL events,
+	*			the one that owns the controller handles (see
+	*			Input::SetDeferred), right after WindowManager::Update.
+	*			Haptic devices are opened the first time their controller
+	*			rumbles and closed once it is unplugged.
+	*/
+	static void Flush();
+
+	/*
+	*	\brief	Returns the counters of the last Flush
+	*/
+	static const Stats & GetStats();
+
+	/*
+	*	\brief	Returns how many requests were lost because the queue was
+	*			full, since Init
+	*/
+	static unsigned GetDroppedRequests();
+
+private:
+	/*
+	*	\brief	One queued request. A strength of 0 stops the rumble.
+	*/
+	struct Request
+	{
+		SDL_JoystickID id;
+		float strength;
+		Uint32 duration;
+		Uint8 priority;
+	};
+
+	/*
+	*	\brief	An effect, either playing on a device or waiting to
+	*			replace the one playing
+	*/
+	struct Effect
+	{
+		float strength;
+		Uint32 until;		//SDL_GetTicks value it ends at
+		Uint8 priority;
+		bool active;
+	};
+
+	/*
+	*	\brief	Haptic device of one controller. 'haptic' is nullptr for
+	*			controllers that cannot rumble, so they are only tried once.
+	*/
+	struct Device
+	{
+		SDL_JoystickID id;
+		SDL_Haptic *haptic;
+		Effect playing;
+		Effect pending;
+		Uint32 last_call;
+	};
+
+	static bool Push(unsigned which, float strength, Uint32 duration, Uint8 priority);
+
+	/*
+	*	\brief	Returns the device of the controller 'id', opening it the
+	*			first time, or nullptr if the controller is gone
+	*/
+	static Device * FindDevice(SDL_JoystickID id);
+
+	/*
+	*	\brief	Folds 'req' into what 'dev' has pending for this frame
+	*/
+	static void Merge(Device &dev, const Request &req, Uint32 now);
+
+	/*
+	*	\brief	Plays or drops the effect pending on 'dev'
+	*/
+	static void Play(Device &dev, Uint32 now);
+
+	static void Close(Device &dev);
+
+	static bool enabled_;
+
+	/*
+	*	\brief	Requests handed from gameplay to Flush
+	*/
+	static SPSCQueue<Request, HAPTICS_QUEUE_SIZE> queue_;
+	static std::atomic<unsigned> dropped_;
+
+	/*
+	*	\brief	Devices opened so far, owned by the thread calling Flush
+	*/
+	static std::vector<Device> devices_;
+
+	static Stats stats_;
+};
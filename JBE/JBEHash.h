@@ -0,0 +1,15 @@
+#pragma once
+
+#include <SDL_stdinc.h>
+
+/*
+*	\brief	32 bit FNV-1a hash of a null terminated string.
+*
+*	\detail	constexpr so names known at compile time (actions, config keys)
+*			are hashed by the compiler and never at runtime.
+*/
+constexpr Uint32 JBEHash(const char *str, Uint32 hash = 2166136261u)
+{
+	return (*str == 0) ? hash :
+		JBEHash(str + 1, static_cast<Uint32>((static_cast<Uint64>(hash ^ static_cast<Uint8>(*str)) * 16777619u) & 0xFFFFFFFFu));
+}
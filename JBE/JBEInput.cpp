@@ -1,167 +1,521 @@
 #include "JBEInput.h"
+#include "JBEInputLog.h"
 
-//Static vars
-std::bitset<INPUT_MAX_CONTROLLERS> Input::controllers_active_;
-char Input::kb_prev_[SDL_NUM_SCANCODES];
-char Input::kb_curr_[SDL_NUM_SCANCODES];
-char Input::m_prev_[Input::MOUSE_NUMBTNS];
-char Input::m_curr_[Input::MOUSE_NUMBTNS];
-char Input::gp_prev_[INPUT_MAX_CONTROLLERS][SDL_CONTROLLER_BUTTON_MAX];
-char Input::gp_curr_[INPUT_MAX_CONTROLLERS][SDL_CONTROLLER_BUTTON_MAX];
-Input::Gamepad_Axes Input::gp_axes_[INPUT_MAX_CONTROLLERS];
+#include <cstring>
 
-void Input::Init()
+//Static vars
+ButtonStates<SDL_NUM_SCANCODES> Input::kb_;
+ButtonStates<Input::MOUSE_NUMBTNS + 1> Input::m_;
+AxisFilter Input::stick_filter_ = { true, 0.24f, 1.0f, 0.0f, 0.0f };
+AxisFilter Input::trigger_filter_ = { false, 0.12f, 1.0f, 0.0f, 0.0f };
+Uint64 Input::frame_time_ = 0;
+Uint64 Input::prev_frame_time_ = 0;
+Uint64 Input::injected_time_ = 0;
+bool Input::time_injected_ = false;
+Uint64 Input::frame_count_ = 0;
+Uint64 Input::counter_freq_ = 1;
+Uint64 Input::pending_[INPUT_LATENCY_SAMPLES];
+unsigned Input::pending_count_ = 0;
+unsigned Input::pending_dropped_ = 0;
+Input::LatencyHistogram Input::frame_latency_;
+Input::LatencyHistogram Input::total_latency_;
+Input::MouseMotion Input::m_live_;
+Input::MouseMotion Input::m_frame_;
+bool Input::deferred_ = false;
+SPSCQueue<Input::Record, INPUT_QUEUE_SIZE> Input::queue_;
+std::atomic<unsigned> Input::dropped_(0);
+InputRecorder *Input::recorder_ = nullptr;
+
+namespace
 {
-	std::memset(kb_curr_, 0, SDL_NUM_SCANCODES);
-	std::memset(kb_prev_, 0, SDL_NUM_SCANCODES);
-
-	std::memset(m_prev_, 0, Input::MOUSE_NUMBTNS);
-	std::memset(m_curr_, 0, Input::MOUSE_NUMBTNS);
+	/*
+	*	\brief	Stores two coordinates in one record field, 16 bits each
+	*/
+	Sint32 PackPair(Sint32 lo, Sint32 hi)
+	{
+		lo = (lo < -32768) ? -32768 : (lo > 32767) ? 32767 : lo;
+		hi = (hi < -32768) ? -32768 : (hi > 32767) ? 32767 : hi;
+		return static_cast<Sint32>((static_cast<Uint32>(hi) << 16) | (static_cast<Uint32>(lo) & 0xFFFF));
+	}
 
-	for (unsigned c = 0; c < INPUT_MAX_CONTROLLERS; ++c)
+	Sint32 UnpackLo(Sint32 packed)
 	{
-		std::memset(gp_prev_[c], 0, SDL_CONTROLLER_BUTTON_MAX);
-		std::memset(gp_curr_[c], 0, SDL_CONTROLLER_BUTTON_MAX);
+		return static_cast<Sint16>(packed & 0xFFFF);
+	}
 
-		gp_axes_[c].ls_x = gp_axes_[c].ls_y = gp_axes_[c].lt =
-		gp_axes_[c].rs_x = gp_axes_[c].rs_y = gp_axes_[c].rt = 0.0f;
+	Sint32 UnpackHi(Sint32 packed)
+	{
+		return static_cast<Sint16>((static_cast<Uint32>(packed) >> 16) & 0xFFFF);
+	}
+}
 
-		SDL_GameController * gc = SDL_GameControllerOpen(c);
-		controllers_active_.set(c, SDL_GameControllerGetAttached(gc) == SDL_TRUE);
+void Input::Init()
+{
+	kb_.Clear();
+	m_.Clear();
+	actions_.Clear();
+
+	std::memset(&m_live_, 0, sizeof(m_live_));
+	std::memset(&m_frame_, 0, sizeof(m_frame_));
+
+	//SDL starts with text input on, only have it while asked for
+	StopTextInput();
+	std::memset(&text_live_, 0, sizeof(text_live_));
+	std::memset(&text_frame_, 0, sizeof(text_frame_));
+	text_dropped_ = 0;
+
+	touch_.Clear();
+	touch_moved_live_.Clear();
+	touch_moved_.Clear();
+	std::memset(touch_live_, 0, sizeof(touch_live_));
+	std::memset(touch_frame_, 0, sizeof(touch_frame_));
+	std::memset(touch_table_, INPUT_MAX_FINGERS, sizeof(touch_table_));
+	touch_key_count_ = 0;
+	SetTouchGestures(false);
+
+	for (unsigned p = 0; p < INPUT_MAX_PLAYERS; ++p)
+		RemovePlayer(p);
+	SetJoinOnPress(false);
+
+	ctx_depth_ = 0;
+	ComputeContextMasks();
+
+	counter_freq_ = SDL_GetPerformanceFrequency();
+	frame_time_ = prev_frame_time_ = SDL_GetPerformanceCounter();
+	time_injected_ = false;
+	pending_count_ = pending_dropped_ = 0;
+	std::memset(&frame_latency_, 0, sizeof(frame_latency_));
+	ResetLatency();
+
+	gp_.clear();
+	gp_axis_btns_.clear();
+	gp_slot_ids_.clear();
+	gp_retired_.clear();
+	gp_retired_.reserve(INPUT_MAX_CONTROLLERS);
+	gp_combos_.clear();
+	gp_count_ = 0;
+	for (unsigned a = 0; a < SDL_CONTROLLER_AXIS_MAX; ++a)
+	{
+		gp_raw_axes_[a].clear();
+		gp_axes_[a].clear();
+		gp_axes_time_[a].clear();
 	}
+
+	GrowControllers(INPUT_MAX_CONTROLLERS);
+
+	//Controllers plugged in before Init, SDL still sends them as added
+	//events, those find them open already
+	for (int device = 0; device < SDL_NumJoysticks(); ++device)
+		if (SDL_IsGameController(device))
+			AddController(OpenController(device));
+
+	frame_count_ = 0;
+	PublishSnapshot();
 }
 
 void Input::Update()
 {
+	//Apply whatever the pump queued since the last frame
+	Record rec;
+	while (queue_.Pop(rec))
+		ApplyRecord(rec);
+
+	prev_frame_time_ = frame_time_;
+	frame_time_ = time_injected_ ? injected_time_ : SDL_GetPerformanceCounter();
+	time_injected_ = false;
+	++frame_count_;
+
+	if (recorder_)
+		recorder_->WriteFrame(frame_time_);
+	UpdateLatency();
+
 	UpdateKeyboard();
 	UpdateMouse();
+	UpdateText();
+	UpdateTouch();
 	UpdateControllers();
+	UpdateCombos();
+	UpdateActions();
+	UpdateContexts();
+	UpdatePlayers();
+
+	PublishSnapshot();
+	DispatchEvents();
 }
 
 bool Input::HandleEvent(SDL_Event * ev)
 {
-	if (HandleKeyboardEvent(ev))
+	//Text does not fit in one record
+	if (ev->type == SDL_TEXTINPUT || ev->type == SDL_TEXTEDITING)
+	{
+		SubmitText(ev);
 		return true;
+	}
 
-	if (HandleMouseEvent(ev))
-		return true;
+	Record rec;
+	if (!MakeRecord(ev, rec))
+		return false;
 
-	if (HandleGamePadEvent(ev))
-		return true;
+	SubmitRecord(rec);
+	return true;
+}
+
+void Input::SubmitRecord(const Record & rec)
+{
+	if (!deferred_)
+		ApplyRecord(rec);
+	else if (!queue_.Push(rec))
+		dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Input::SetDeferred(bool deferred)
+{
+	deferred_ = deferred;
+}
+
+unsigned Input::GetDroppedRecords()
+{
+	return dropped_.load(std::memory_order_relaxed);
+}
+
+void Input::SetRecorder(InputRecorder * rec)
+{
+	recorder_ = rec;
+}
+
+void Input::InjectRecord(const Record & rec, bool keep_counter)
+{
+	if (keep_counter)
+	{
+		ApplyRecord(rec);
+		return;
+	}
+
+	//Recorded counters belong to another run, measure from now instead
+	Record copy = rec;
+	copy.counter = SDL_GetPerformanceCounter();
+
+	ApplyRecord(copy);
+}
 
-	return false;
+void Input::InjectFrameTime(Uint64 counter)
+{
+	injected_time_ = counter;
+	time_injected_ = true;
+}
+
+Uint64 Input::GetFrameTime()
+{
+	return frame_time_;
+}
+
+Uint64 Input::GetFrameCount()
+{
+	return frame_count_;
+}
+
+double Input::GetKeyAge(SDL_Scancode sc)
+{
+	return CounterToSeconds(frame_time_ - kb_.changed_at[sc]);
+}
+
+double Input::GetMouseButtonAge(MOUSE_BTN m)
+{
+	return CounterToSeconds(frame_time_ - m_.changed_at[m]);
+}
+
+double Input::GetGamePadButtonAge(unsigned which, SDL_GameControllerButton btn)
+{
+	if (which >= gp_.size())
+		return 0.0;
+
+	return CounterToSeconds(frame_time_ - gp_[which].changed_at[btn]);
+}
+
+double Input::GetGamePadAxisAge(unsigned which, SDL_GameControllerAxis axis)
+{
+	if (which >= gp_.size())
+		return 0.0;
+
+	return CounterToSeconds(frame_time_ - gp_axes_time_[axis][which]);
+}
+
+const Input::LatencyHistogram & Input::GetFrameLatency()
+{
+	return frame_latency_;
+}
+
+const Input::LatencyHistogram & Input::GetTotalLatency()
+{
+	return total_latency_;
+}
+
+void Input::ResetLatency()
+{
+	std::memset(&total_latency_, 0, sizeof(total_latency_));
 }
 
 bool Input::IsKeyTriggered(SDL_Scancode sc)
 {
-	return kb_curr_[sc] == 1;
+	return kb_.triggered.Test(sc);
 }
 
 bool Input::IsKeyPressed(SDL_Scancode sc)
 {
-	return kb_curr_[sc] == 2;
+	return kb_.pressed.Test(sc);
 }
 
 bool Input::IsKeyReleased(SDL_Scancode sc)
 {
-	return kb_curr_[sc] == 3;
+	return kb_.released.Test(sc);
 }
 
 bool Input::IsMouseButtonTriggered(MOUSE_BTN m)
 {
-	return m_curr_[m] == 1;
+	return m_.triggered.Test(m);
 }
 
 bool Input::IsMouseButtonPressed(MOUSE_BTN m)
 {
-	return m_curr_[m] == 2;
+	return m_.pressed.Test(m);
 }
 
 bool Input::IsMouseButtonReleased(MOUSE_BTN m)
 {
-	return m_curr_[m] == 3;
+	return m_.released.Test(m);
 }
 
 int Input::GetMouseWheelDelta()
 {
-	return 0;
+	return m_frame_.wheel_y;
 }
 
 int Input::GetMousePosX()
 {
-	return 0;
+	return m_frame_.x;
 }
 
 int Input::GetMousePosY()
 {
-	return 0;
+	return m_frame_.y;
+}
+
+int Input::GetMouseDeltaX()
+{
+	return m_frame_.dx;
+}
+
+int Input::GetMouseDeltaY()
+{
+	return m_frame_.dy;
+}
+
+int Input::GetMouseWheelDeltaX()
+{
+	return m_frame_.wheel_x;
+}
+
+bool Input::SetRelativeMouseMode(bool relative)
+{
+	return SDL_SetRelativeMouseMode(relative ? SDL_TRUE : SDL_FALSE) == 0;
+}
+
+bool Input::IsRelativeMouseMode()
+{
+	return SDL_GetRelativeMouseMode() == SDL_TRUE;
 }
 
 bool Input::IsGamePadTriggered(unsigned which, SDL_GameControllerButton btn)
 {
-	return gp_curr_[which][btn] == 1;
+	return which < gp_.size() && gp_[which].triggered.Test(btn);
 }
 
 bool Input::IsGamePadPressed(unsigned which, SDL_GameControllerButton btn)
 {
-	return gp_curr_[which][btn] == 2;
+	return which < gp_.size() && gp_[which].pressed.Test(btn);
 }
 
 bool Input::IsGamePadReleased(unsigned which, SDL_GameControllerButton btn)
 {
-	return gp_curr_[which][btn] == 3;
+	return which < gp_.size() && gp_[which].released.Test(btn);
 }
 
 float Input::GamePadLeftTriggerValue(unsigned which)
 {
-	return gp_axes_[which].lt;
+	return GamePadAxisValue(which, SDL_CONTROLLER_AXIS_TRIGGERLEFT);
 }
 
 float Input::GamePadRightTriggerValue(unsigned which)
 {
-	return gp_axes_[which].rt;
+	return GamePadAxisValue(which, SDL_CONTROLLER_AXIS_TRIGGERRIGHT);
 }
 
 float Input::GamePadLeftStickXValue(unsigned which)
 {
-	return gp_axes_[which].ls_x;
+	return GamePadAxisValue(which, SDL_CONTROLLER_AXIS_LEFTX);
 }
 
 float Input::GamePadLeftStickYValue(unsigned which)
 {
-	return gp_axes_[which].ls_y;
+	return GamePadAxisValue(which, SDL_CONTROLLER_AXIS_LEFTY);
 }
 
 float Input::GamePadRightStickXValue(unsigned which)
 {
-	return gp_axes_[which].rs_x;
+	return GamePadAxisValue(which, SDL_CONTROLLER_AXIS_RIGHTX);
 }
 
 float Input::GamePadRightStickYValue(unsigned which)
 {
-	return gp_axes_[which].rs_y;
+	return GamePadAxisValue(which, SDL_CONTROLLER_AXIS_RIGHTY);
 }
 
-std::vector<unsigned> Input::GetActiveControllers()
+float Input::GamePadAxisValue(unsigned which, SDL_GameControllerAxis axis)
 {
-	std::vector<unsigned> retval;
+	return (which < gp_.size()) ? gp_axes_[axis][which] : 0.0f;
+}
 
-	for (unsigned i = 0; i < INPUT_MAX_CONTROLLERS; ++i)
-		if (controllers_active_[i] == 1)
-			retval.push_back(i);
+Input::Gamepad_Axes Input::GetGamePadAxes(unsigned which)
+{
+	Gamepad_Axes axes;
+	axes.ls_x = GamePadAxisValue(which, SDL_CONTROLLER_AXIS_LEFTX);
+	axes.ls_y = GamePadAxisValue(which, SDL_CONTROLLER_AXIS_LEFTY);
+	axes.rs_x = GamePadAxisValue(which, SDL_CONTROLLER_AXIS_RIGHTX);
+	axes.rs_y = GamePadAxisValue(which, SDL_CONTROLLER_AXIS_RIGHTY);
+	axes.rt = GamePadAxisValue(which, SDL_CONTROLLER_AXIS_TRIGGERRIGHT);
+	axes.lt = GamePadAxisValue(which, SDL_CONTROLLER_AXIS_TRIGGERLEFT);
+	return axes;
+}
+
+float Input::GamePadRawAxisValue(unsigned which, SDL_GameControllerAxis axis)
+{
+	return (which < gp_.size()) ? gp_raw_axes_[axis][which] : 0.0f;
+}
+
+void Input::SetStickFilter(const AxisFilter & filter)
+{
+	stick_filter_ = filter;
+}
+
+void Input::SetTriggerFilter(const AxisFilter & filter)
+{
+	trigger_filter_ = filter;
+}
 
-	return retval;
+const AxisFilter & Input::GetStickFilter()
+{
+	return stick_filter_;
 }
 
-bool Input::HandleKeyboardEvent(SDL_Event * ev)
+const AxisFilter & Input::GetTriggerFilter()
 {
+	return trigger_filter_;
+}
+
+bool Input::MakeRecord(const SDL_Event * ev, Record & rec)
+{
+	rec.which = 0;
+	rec.code = 0;
+	rec.value = 0;
+
 	switch (ev->type)
+	{
+	case SDL_KEYDOWN:
+	case SDL_KEYUP:
+		rec.code = static_cast<Uint16>(ev->key.keysym.scancode);
+		break;
+	case SDL_MOUSEBUTTONDOWN:
+	case SDL_MOUSEBUTTONUP:
+		rec.which = static_cast<Sint32>(ev->button.which);
+		rec.code = ev->button.button;
+		break;
+	case SDL_MOUSEMOTION:
+		rec.which = PackPair(ev->motion.x, ev->motion.y);
+		rec.value = PackPair(ev->motion.xrel, ev->motion.yrel);
+		break;
+	case SDL_MOUSEWHEEL:
+		rec.which = ev->wheel.x;
+		rec.value = ev->wheel.y;
+		break;
+	case SDL_FINGERDOWN:
+	case SDL_FINGERUP:
+	case SDL_FINGERMOTION:
+		if (!MakeTouchRecord(ev->tfinger, rec))
+			return false;
+		break;
+	case SDL_CONTROLLERDEVICEADDED:
+		//'which' is a device index here, only good until the next
+		//hot-plug, the record carries the instance ID instead
+		rec.which = OpenController(ev->cdevice.which);
+		break;
+	case SDL_CONTROLLERDEVICEREMOVED:
+		CloseController(ev->cdevice.which);
+		rec.which = ev->cdevice.which;
+		break;
+	case SDL_CONTROLLERBUTTONDOWN:
+	case SDL_CONTROLLERBUTTONUP:
+		rec.which = ev->cbutton.which;
+		rec.code = ev->cbutton.button;
+		break;
+	case SDL_CONTROLLERAXISMOTION:
+		rec.which = ev->caxis.which;
+		rec.code = ev->caxis.axis;
+		rec.value = ev->caxis.value;
+		break;
+	default: //not input related
+		return false;
+	}
+
+	rec.type = static_cast<Uint16>(ev->type);
+	StampRecord(rec, ev->common.timestamp);
+	return true;
+}
+
+void Input::StampRecord(Record & rec, Uint32 timestamp)
+{
+	rec.timestamp = timestamp;
+
+	//SDL only stamps events in ms, move that back from a precise "now"
+	Uint64 now = SDL_GetPerformanceCounter();
+	Uint32 ticks = SDL_GetTicks();
+	Uint64 queued = (ticks > rec.timestamp) ? (ticks - rec.timestamp) * counter_freq_ / 1000 : 0;
+	rec.counter = (queued < now) ? now - queued : now;
+}
+
+void Input::ApplyRecord(const Record & rec)
+{
+	if (recorder_)
+		recorder_->Write(rec);
+
+	if (pending_count_ < INPUT_LATENCY_SAMPLES)
+		pending_[pending_count_++] = rec.counter;
+	else
+		++pending_dropped_;
+
+	if (HandleKeyboardEvent(rec))
+		return;
+
+	if (HandleMouseEvent(rec))
+		return;
+
+	if (HandleTextEvent(rec))
+		return;
+
+	if (HandleTouchEvent(rec))
+		return;
+
+	HandleGamePadEvent(rec);
+}
+
+bool Input::HandleKeyboardEvent(const Record & rec)
+{
+	switch (rec.type)
 	{
 		case SDL_KEYDOWN:
-			kb_curr_[ev->key.keysym.scancode] = 1;
+			kb_.Set(rec.code, true, rec.counter);
 			break;
 		case SDL_KEYUP:
-			kb_curr_[ev->key.keysym.scancode] = 0;
+			kb_.Set(rec.code, false, rec.counter);
 			break;
 		default: //not our message
 			return false;
@@ -170,17 +524,26 @@ bool Input::HandleKeyboardEvent(SDL_Event * ev)
 	return true;
 }
 
-bool Input::HandleMouseEvent(SDL_Event * ev)
+bool Input::HandleMouseEvent(const Record & rec)
 {
-	switch (ev->type)
+	switch (rec.type)
 	{
 		case SDL_MOUSEBUTTONDOWN:
-			m_curr_[ev->button.button] = 1;
-			break;
 		case SDL_MOUSEBUTTONUP:
-			m_curr_[ev->button.button]= 0;
+			if (rec.code <= MOUSE_NUMBTNS)
+				m_.Set(rec.code, rec.type == SDL_MOUSEBUTTONDOWN, rec.counter);
+			break;
+		case SDL_MOUSEMOTION:
+			//Coalesced, only the last position and the total motion are kept
+			m_live_.x = UnpackLo(rec.which);
+			m_live_.y = UnpackHi(rec.which);
+			m_live_.dx += UnpackLo(rec.value);
+			m_live_.dy += UnpackHi(rec.value);
+			break;
+		case SDL_MOUSEWHEEL:
+			m_live_.wheel_x += rec.which;
+			m_live_.wheel_y += rec.value;
 			break;
-			//TODO add support for scrollwheel and logging mouse position
 		default: //not our message
 			return false;
 	}
@@ -188,43 +551,30 @@ bool Input::HandleMouseEvent(SDL_Event * ev)
 	return true;
 }
 
-bool Input::HandleGamePadEvent(SDL_Event * ev)
+bool Input::HandleGamePadEvent(const Record & rec)
 {
-	switch (ev->type)
+	int slot;
+
+	switch (rec.type)
 	{
 	case SDL_CONTROLLERDEVICEADDED:
-		controllers_active_.set(ev->cdevice.which, true);
+		AddController(rec.which);
 		break;
 	case SDL_CONTROLLERDEVICEREMOVED:
-		controllers_active_.set(ev->cdevice.which, false);
+		RemoveController(rec.which, rec.counter);
 		break;
 	case SDL_CONTROLLERBUTTONDOWN:
-		gp_curr_[ev->cbutton.which][ev->cbutton.button] = 1;
-		break;
 	case SDL_CONTROLLERBUTTONUP:
-		gp_curr_[ev->cbutton.which][ev->cbutton.button] = 0;
+		slot = GetControllerSlot(rec.which);
+		if (slot >= 0 && rec.code < SDL_CONTROLLER_BUTTON_MAX)
+			gp_[slot].Set(rec.code, rec.type == SDL_CONTROLLERBUTTONDOWN, rec.counter);
 		break;
 	case SDL_CONTROLLERAXISMOTION:
-		switch (ev->caxis.axis)
+		slot = GetControllerSlot(rec.which);
+		if (slot >= 0 && rec.code < SDL_CONTROLLER_AXIS_MAX)
 		{
-			case SDL_CONTROLLER_AXIS_LEFTX:
-				gp_axes_[ev->caxis.which].ls_x = static_cast<float>(ev->caxis.value) / 32768.0f;
-				break;
-			case SDL_CONTROLLER_AXIS_LEFTY:
-				gp_axes_[ev->caxis.which].ls_y = static_cast<float>(ev->caxis.value) / 32768.0f;
-				break;
-			case SDL_CONTROLLER_AXIS_RIGHTX:
-				gp_axes_[ev->caxis.which].rs_x = static_cast<float>(ev->caxis.value) / 32768.0f;
-				break;
-			case SDL_CONTROLLER_AXIS_RIGHTY:
-				gp_axes_[ev->caxis.which].rs_y = static_cast<float>(ev->caxis.value) / 32768.0f;
-				break;
-			case SDL_CONTROLLER_AXIS_TRIGGERLEFT:
-				gp_axes_[ev->caxis.which].lt = static_cast<float>(ev->caxis.value) / 32768.0f;
-				break;
-			case SDL_CONTROLLER_AXIS_TRIGGERRIGHT:
-				gp_axes_[ev->caxis.which].rt = static_cast<float>(ev->caxis.value) / 32768.0f;
-				break;
+			gp_raw_axes_[rec.code][slot] = static_cast<float>(rec.value) / 32768.0f;
+			gp_axes_time_[rec.code][slot] = rec.counter;
 		}
 		break;
 
@@ -235,59 +585,81 @@ bool Input::HandleGamePadEvent(SDL_Event * ev)
 	return true;
 }
 
-void Input::UpdateControllers()
+void Input::UpdateLatency()
 {
-	for (unsigned controller = 0; controller < INPUT_MAX_CONTROLLERS; controller++)
-	for (unsigned i = 0; i < SDL_CONTROLLER_BUTTON_MAX; ++i)
+	std::memset(&frame_latency_, 0, sizeof(frame_latency_));
+	frame_latency_.dropped = pending_dropped_;
+
+	for (unsigned i = 0; i < pending_count_; ++i)
 	{
-		if (gp_prev_[controller][i] == 0 && gp_curr_[controller][i] == 1)
-			gp_prev_[controller][i] = 1;
-		else if (gp_prev_[controller][i] == 1 && gp_curr_[controller][i] == 1) //second frame down, set to pressed
-			gp_curr_[controller][i] = 2;
-		else if (gp_prev_[controller][i] != 0 && gp_curr_[controller][i] == 0) //key was released
-		{
-			gp_curr_[controller][i] = 3;
-			gp_prev_[controller][i] = 0;
-		}
-		else if (gp_curr_[controller][i] == 3)
-			gp_curr_[controller][i] = 0;
+		Uint64 age = (frame_time_ > pending_[i]) ? frame_time_ - pending_[i] : 0;
+		Uint64 us = age * 1000000 / counter_freq_;
+
+		unsigned bucket = 0;
+		while (bucket + 1 < INPUT_LATENCY_BUCKETS && (us >> bucket) != 0)
+			++bucket;
+
+		++frame_latency_.buckets[bucket];
+		frame_latency_.total_us += us;
+		if (us > frame_latency_.max_us)
+			frame_latency_.max_us = us;
 	}
+
+	frame_latency_.count = pending_count_;
+	pending_count_ = pending_dropped_ = 0;
+
+	for (unsigned b = 0; b < INPUT_LATENCY_BUCKETS; ++b)
+		total_latency_.buckets[b] += frame_latency_.buckets[b];
+
+	total_latency_.count += frame_latency_.count;
+	total_latency_.dropped += frame_latency_.dropped;
+	total_latency_.total_us += frame_latency_.total_us;
+	if (frame_latency_.max_us > total_latency_.max_us)
+		total_latency_.max_us = frame_latency_.max_us;
+}
+
+double Input::CounterToSeconds(Uint64 counter)
+{
+	return static_cast<double>(counter) / static_cast<double>(counter_freq_);
+}
+
+Uint64 Input::SecondsToCounter(double seconds)
+{
+	return (seconds > 0.0) ? static_cast<Uint64>(seconds * static_cast<double>(counter_freq_)) : 0;
+}
+
+void Input::UpdateControllers()
+{
+	const unsigned count = static_cast<unsigned>(gp_.size());
+
+	for (unsigned controller = 0; controller < count; controller++)
+		gp_[controller].Update();
+
+	//Filter every controller at once, the raw values stay untouched
+	for (unsigned a = 0; a < SDL_CONTROLLER_AXIS_MAX; ++a)
+		std::memcpy(gp_axes_[a].data(), gp_raw_axes_[a].data(), count * sizeof(float));
+
+	FilterSticks(gp_axes_[SDL_CONTROLLER_AXIS_LEFTX].data(), gp_axes_[SDL_CONTROLLER_AXIS_LEFTY].data(), count, stick_filter_);
+	FilterSticks(gp_axes_[SDL_CONTROLLER_AXIS_RIGHTX].data(), gp_axes_[SDL_CONTROLLER_AXIS_RIGHTY].data(), count, stick_filter_);
+	FilterTriggers(gp_axes_[SDL_CONTROLLER_AXIS_TRIGGERLEFT].data(), count, trigger_filter_);
+	FilterTriggers(gp_axes_[SDL_CONTROLLER_AXIS_TRIGGERRIGHT].data(), count, trigger_filter_);
+
+	UpdateAxisButtons();
+
+	//Releases of unplugged controllers are applied, their slots can go
+	gp_retired_.clear();
 }
 
 void Input::UpdateMouse()
 {
-	for (unsigned i = 0; i < Input::MOUSE_NUMBTNS; ++i)
-	{
-		if (m_prev_[i] == 0 && m_curr_[i] == 1)
-			m_prev_[i] = 1;
-		else if (m_prev_[i] == 1 && m_curr_[i] == 1) //second frame down, set to pressed
-			m_curr_[i] = 2;
-		else if (m_prev_[i] != 0 && m_curr_[i] == 0) //key was released
-		{
-			m_curr_[i] = 3;
-			m_prev_[i] = 0;
-		}
-		else if (m_curr_[i] == 3)
-			m_curr_[i] = 0;
-	}
+	m_.Update();
 
-	//Clear scroll value here when implemented
+	m_frame_ = m_live_;
+	m_live_.dx = m_live_.dy = 0;
+	m_live_.wheel_x = m_live_.wheel_y = 0;
 }
 
 void Input::UpdateKeyboard()
 {
-	for (unsigned i = 0; i < SDL_NUM_SCANCODES; ++i)
-	{
-		if (kb_prev_[i] == 0 && kb_curr_[i] == 1)
-			kb_prev_[i] = 1;
-		else if (kb_prev_[i] == 1 && kb_curr_[i] == 1) //second frame down, set to pressed
-			kb_curr_[i] = 2;
-		else if (kb_prev_[i] != 0 && kb_curr_[i] == 0) //key was released
-		{
-			kb_curr_[i] = 3;
-			kb_prev_[i] = 0;
-		}
-		else if (kb_curr_[i] == 3)
-			kb_curr_[i] = 0;
-	}
+	kb_.Update();
 }
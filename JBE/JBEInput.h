@@ -1,10 +1,49 @@
 #pragma once
 #define INPUT_MAX_CONTROLLERS 8
+#define INPUT_QUEUE_SIZE 4096
+#define INPUT_MAX_ACTIONS 64
+#define INPUT_MAX_BINDINGS 256
+#define INPUT_LATENCY_BUCKETS 16
+#define INPUT_LATENCY_SAMPLES 1024
+#define INPUT_SNAPSHOT_POOL 4
+#define INPUT_HISTORY_FRAMES 64
+#define INPUT_MAX_COMBOS 64
+#define INPUT_COMBO_MAX_SYMBOLS 16
+#define INPUT_TEXT_CAPACITY 256
+#define INPUT_COMPOSITION_CAPACITY 64
+#define INPUT_MAX_FINGERS 16
+#define INPUT_MAX_PLAYERS 8
+#define INPUT_MAX_SUBSCRIPTIONS 256
+#define INPUT_MAX_CONTEXTS 8
+#define INPUT_DOUBLE_TAP_WINDOW 0.3
+#define INPUT_REPEAT_DELAY 0.5
+#define INPUT_REPEAT_INTERVAL 0.05
+#define INPUT_AXIS_PRESS 0.5f
+#define INPUT_AXIS_RELEASE 0.35f
+
+#include "JBEAxisFilter.h"
+#include "JBEDelegate.h"
+#include "JBEHash.h"
+#include "JBEInputBits.h"
+#include "JBEInputQueue.h"
 
 #include <SDL.h>
-#include <bitset>
+#include <atomic>
+#include <type_traits>
 #include <vector>
 
+/*
+*	\brief	Compile time ID for the action called 'name', e.g.
+*			INPUT_ACTION("Jump"). The string is hashed by the compiler.
+*/
+#define INPUT_ACTION(name) (std::integral_constant<Input::ActionID, JBEHash(name)>::value)
+
+class InputRecorder;
+class InputSnapshot;
+class InputQuery;
+class Config;
+class ConfigWriter;
+
 class Input 
 {
 public:
@@ -15,6 +54,7 @@ public:
 		CONTROLLER,
 		KEYBOARD,
 		MOUSE,
+		TOUCH,
 
 		NUM_INPUT_SRCS
 	};
@@ -32,6 +72,11 @@ public:
 		MOUSE_NUMBTNS = MOUSE_X2
 	};
 
+	/*
+	*	\brief	Filtered axes of one controller, see GetGamePadAxes. Axes
+	*			are stored per axis for every controller, this is only a
+	*			copy for code that wants them together.
+	*/
 	struct Gamepad_Axes
 	{
 		float ls_x;
@@ -44,6 +89,166 @@ public:
 		float lt;
 	};
 
+	/*
+	*	\brief	Virtual buttons for each direction of each stick axis and
+	*			for each trigger, see IsGamePadAxisTriggered. Y axes are
+	*			positive downwards, like SDL reports them.
+	*/
+	enum AXIS_BTN
+	{
+		AXIS_LEFTX_NEG,
+		AXIS_LEFTX_POS,
+		AXIS_LEFTY_NEG,
+		AXIS_LEFTY_POS,
+		AXIS_RIGHTX_NEG,
+		AXIS_RIGHTX_POS,
+		AXIS_RIGHTY_NEG,
+		AXIS_RIGHTY_POS,
+		AXIS_TRIGGERLEFT,
+		AXIS_TRIGGERRIGHT,
+
+		AXIS_NUMBTNS
+	};
+
+	/*
+	*	\brief	Hashed name of an action, see INPUT_ACTION. 0 is not a valid ID.
+	*/
+	typedef Uint32 ActionID;
+
+	enum EVENT_TYPE : Uint8
+	{
+		EVENT_KEY,
+		EVENT_MOUSE_BUTTON,
+		EVENT_GAMEPAD_BUTTON,
+		EVENT_ACTION
+	};
+
+	/*
+	*	\brief	What a subscriber is told. 'code' is the scancode, MOUSE_BTN,
+	*			button or ActionID subscribed to, 'which' the controller
+	*			(-1 for the other types).
+	*/
+	struct InputEvent
+	{
+		EVENT_TYPE type;
+		bool down;
+		int which;
+		Uint32 code;
+	};
+
+	typedef Delegate<void(const InputEvent &)> InputCallback;
+
+	/*
+	*	\brief	Handle of a subscription, 0 is not a valid one
+	*/
+	typedef Uint32 SubscriptionID;
+
+	/*
+	*	\brief	Read only view of UTF-8 text owned by Input, not null
+	*			terminated. Valid until the next Update.
+	*/
+	struct TextView
+	{
+		const char *data;
+		unsigned size;
+	};
+
+	/*
+	*	\brief	Pinch and rotation of the fingers touching the screen, see
+	*			SetTouchGestures
+	*/
+	struct TouchGesture
+	{
+		unsigned fingers;	//fingers down this frame and the previous one
+		float x;			//center of those fingers, normalized like GetTouchX
+		float y;
+		float pinch;		//how much they spread this frame, 1 for no change
+		float rotation;		//how much they turned this frame, radians clockwise
+	};
+
+	/*
+	*	\brief	Result of Input::Query, bit 'i' stands for the 'i'th input
+	*			added to the InputQuery
+	*/
+	struct QueryResult
+	{
+		Uint64 triggered;
+		Uint64 pressed;
+		Uint64 released;
+	};
+
+	/*
+	*	\brief	State of one game pad in one frame, as kept by the history.
+	*			Directions use numpad notation: 5 is neutral, 2 down, 6 right,
+	*			3 down-right and so on, from the dpad or the left stick.
+	*/
+	struct PadFrame
+	{
+		Uint8 direction;	//1 to 9
+		Uint32 buttons;		//bit per SDL_GameControllerButton held
+	};
+
+	/*
+	*	\brief	Compact input of one player in one frame, see
+	*			CapturePlayerInput. Plain data, so it can be copied,
+	*			compared with memcmp and sent over the network as is.
+	*/
+	struct PlayerInput
+	{
+		Uint32 buttons;		//bit per SDL_GameControllerButton held
+		Sint16 axes[SDL_CONTROLLER_AXIS_MAX];	//filtered axes, scaled to +-32767
+		Uint64 actions;		//bit per action down, in the order they were bound
+	};
+
+	/*
+	*	\brief	One step of a combo: a direction (numpad notation, 0 for
+	*			none), then a button press (SDL_CONTROLLER_BUTTON_INVALID
+	*			for none). A step with both, e.g. { 6, SDL_CONTROLLER_BUTTON_X }
+	*			for forward + X, is the direction followed by the press.
+	*/
+	struct ComboStep
+	{
+		Uint8 direction;
+		Sint8 button;
+	};
+
+	/*
+	*	\brief	Compact form of an input event. HandleEvent turns every input
+	*			related SDL_Event into one of these before applying it.
+	*			Mouse motion packs its x/y pairs as two 16 bit halves. Text
+	*			events are split into records of up to 8 bytes of UTF-8
+	*			each, stored in 'which' and 'value', with 'code' holding
+	*			the byte count. Touch records pack the finger's position
+	*			in 'value' as two 16 bit fractions of the window, and hold
+	*			a key for the finger in 'which', see MakeTouchRecord.
+	*/
+	struct Record
+	{
+		Uint64 counter;		//SDL_GetPerformanceCounter estimate of when the event happened
+		Uint32 timestamp;	//SDL timestamp of the event (ms)
+		Uint16 type;		//SDL_EventType
+		Uint16 code;		//scancode, button, axis or touch pressure
+		Sint32 which;		//controller instance id, finger, mouse position, horizontal wheel
+		Sint32 value;		//axis value, relative mouse motion, vertical wheel
+	};
+
+	/*
+	*	\brief	Distribution of how long input events waited between
+	*			happening and being seen by Update.
+	*
+	*	\detail	Bucket 'b' counts ages in [2^(b-1), 2^b) microseconds,
+	*			bucket 0 counts ages under 1us and the last bucket counts
+	*			everything that did not fit in the others.
+	*/
+	struct LatencyHistogram
+	{
+		unsigned buckets[INPUT_LATENCY_BUCKETS];
+		unsigned count;		//events measured
+		unsigned dropped;	//events past INPUT_LATENCY_SAMPLES in a frame, not measured
+		Uint64 total_us;	//sum of every measured age
+		Uint64 max_us;		//oldest measured age
+	};
+
 	/*
 	*	\name	Init
 	*
@@ -52,9 +257,10 @@ public:
 	*
 	*	\detail	Sets up the storage buffers for last state and 
 	*			current state for keyboard, mouse and controller (s).
-	*			Will set up enough space for 8 controllers.
-	*			Will use flags to determine how many are actually active
-	*			at any time.
+	*			Will set up enough space for INPUT_MAX_CONTROLLERS
+	*			controllers and open every one already plugged in. More
+	*			controllers than that still fit, the storage grows when
+	*			they are plugged in (see GetControllerSlot).
 	*/
 	static void Init();
 
@@ -64,15 +270,21 @@ public:
 	*	\brief	Updates the current buffers depending on last frame and 
 	*			current frame input.
 	*
-	*	\detail	Will call the update handlers of all input subtyped
+	*	\detail	Applies every record queued by HandleEvent in deferred mode
+	*			first, then will call the update handlers of all input subtyped
 	*			which will set the current input state to one of the 
 	*			following
 	*			<li>
-	*			0 = not pressed (up this frame, down the previous)
-	*			1 = triggered (first frame down, not persistent)
-	*			2 = pressed (down for more than one frame, persistent)
-	*			3 = released this frame (first frame up, not persistent)
+	*			not pressed (up this frame and the previous)
+	*			triggered (first frame down, not persistent)
+	*			pressed (down for more than one frame, persistent)
+	*			released this frame (first frame up, not persistent)
 	*			</li>
+	*			Each state is kept as a bitset (see ButtonStates), so the
+	*			Is*Triggered/Pressed/Released queries are single bit tests,
+	*			and only the buttons touched since the last frames are
+	*			visited, an idle frame costs next to nothing.
+	*			Last, the new state is published as an InputSnapshot.
 	*/
 	static void Update();
 
@@ -80,10 +292,86 @@ public:
 	*	\name	HandleEvent
 	*
 	*	\brief	Interprets the given event and sets the current keyboard
+	*
+	*	\detail	In deferred mode the event is only queued and the state is
+	*			changed by the next call to Update instead.
+	*
 	*	\returns	true if this event was input related, false otherwise	
 	*/
 	static bool HandleEvent(SDL_Event *ev);
 
+	/*
+	*	\name	SetDeferred
+	*
+	*	\brief	Chooses whether HandleEvent applies events right away or
+	*			queues them for Update.
+	*
+	*	\detail	Deferred mode lets the SDL event pump (HandleEvent) and the
+	*			simulation (Update and every query) run on two different
+	*			threads. Events travel through a lock free single producer,
+	*			single consumer queue of INPUT_QUEUE_SIZE records, so there
+	*			must be exactly one pumping thread and one updating thread.
+	*			Only switch modes while neither of them is running.
+	*/
+	static void SetDeferred(bool deferred);
+
+	/*
+	*	\brief	Returns how many records were lost because the deferred
+	*			queue was full when HandleEvent ran.
+	*/
+	static unsigned GetDroppedRecords();
+
+	/*
+	*	\name	SetRecorder
+	*
+	*	\brief	Starts logging every record applied to the input state, and
+	*			a frame marker per Update, into 'rec'. Pass nullptr to stop.
+	*
+	*	\detail	Records are logged on the thread that applies them (the one
+	*			calling Update in deferred mode), in the order they were
+	*			applied, so replaying the log rebuilds the exact same state.
+	*/
+	static void SetRecorder(InputRecorder *rec);
+
+	/*
+	*	\brief	Applies 'rec' as if it had come from HandleEvent and then
+	*			Update. Used to play back recorded input without SDL.
+	*
+	*	\detail	'rec' is stamped with the current time unless 'keep_counter'
+	*			is set. InputReplay keeps the recorded times, moved to this
+	*			run's clock, so timing queries replay exactly.
+	*/
+	static void InjectRecord(const Record &rec, bool keep_counter = false);
+
+	/*
+	*	\brief	Makes the next Update run at 'counter' rather than at the
+	*			current time, see InjectRecord.
+	*/
+	static void InjectFrameTime(Uint64 counter);
+
+	/*
+	*	\name	AcquireSnapshot
+	*
+	*	\brief	Returns the snapshot published by the last Update, which
+	*			stays valid and unchanged until it is handed back with
+	*			ReleaseSnapshot. Returns nullptr before Init.
+	*
+	*	\detail	The queries below read the state HandleEvent and Update
+	*			change, so they are only safe on the thread running those.
+	*			Other threads (jobs running alongside the pump) should read
+	*			a snapshot instead. Acquiring never locks: Update fills one
+	*			of INPUT_SNAPSHOT_POOL buffers no reader holds and swaps it
+	*			in with an atomic pointer. If readers hold every other
+	*			buffer, Update leaves the previous snapshot published, so
+	*			hold on to one for a frame or two at most.
+	*/
+	static const InputSnapshot * AcquireSnapshot();
+
+	/*
+	*	\brief	Hands back a snapshot returned by AcquireSnapshot
+	*/
+	static void ReleaseSnapshot(const InputSnapshot *snapshot);
+
 	/*
 	*	\brief	Returns whether the keyboard key 'sc' was pressed this frame
 	*			for the first time
@@ -102,6 +390,27 @@ public:
 	*/
 	static bool IsKeyReleased(SDL_Scancode sc);
 
+	/*
+	*	\brief	Returns the SDL_GetPerformanceCounter value taken by the last
+	*			Update. Every age below is measured up to this point.
+	*/
+	static Uint64 GetFrameTime();
+
+	/*
+	*	\brief	Returns how many times Update has run since Init
+	*/
+	static Uint64 GetFrameCount();
+
+	/*
+	*	\brief	Returns the seconds between the last change of the key 'sc'
+	*			and the last Update.
+	*
+	*	\detail	While the key is triggered or released this is how long
+	*			the event waited before Update saw it, while it is pressed
+	*			it is how long it has been held.
+	*/
+	static double GetKeyAge(SDL_Scancode sc);
+
 	/*
 	*	\brief	Returns whether the mouse button 'm' was pressed this frame
 	*			for the first time
@@ -120,6 +429,12 @@ public:
 	*/
 	static bool IsMouseButtonReleased(MOUSE_BTN m);
 	
+	/*
+	*	\brief	Returns the seconds between the last change of the mouse
+	*			button 'm' and the last Update. See GetKeyAge.
+	*/
+	static double GetMouseButtonAge(MOUSE_BTN m);
+
 	/*
 	*	\brief	Returns how much the mouse wheel scrolled up (positive) 
 	*			or down (negative) this frame.
@@ -136,6 +451,178 @@ public:
 	*/
 	static int GetMousePosY();
 
+	/*
+	*	\brief	Returns how far the mouse moved horizontally this frame,
+	*			every motion event since the last frame added up
+	*/
+	static int GetMouseDeltaX();
+
+	/*
+	*	\brief	Returns how far the mouse moved vertically this frame,
+	*			every motion event since the last frame added up
+	*/
+	static int GetMouseDeltaY();
+
+	/*
+	*	\brief	Returns how much the mouse wheel scrolled right (positive)
+	*			or left (negative) this frame.
+	*/
+	static int GetMouseWheelDeltaX();
+
+	/*
+	*	\name	SetRelativeMouseMode
+	*
+	*	\brief	Hides the cursor and reports unbounded relative motion only.
+	*
+	*	\detail	In relative mode the position stays put and GetMouseDeltaX/Y
+	*			keep working past the edges of the window, which is what
+	*			camera controls and high polling rate mice want.
+	*
+	*	\retval	true	The mode was changed.
+	*	\retval false	Relative mode is not supported.
+	*/
+	static bool SetRelativeMouseMode(bool relative);
+
+	/*
+	*	\brief	Returns whether relative mouse mode is on
+	*/
+	static bool IsRelativeMouseMode();
+
+	/*
+	*	\name	StartTextInput
+	*
+	*	\brief	Starts text input mode, SDL then sends typed text and shows
+	*			the IME if there is one. Call it from the thread that
+	*			created the window.
+	*
+	*	\detail	Text typed each frame is appended to a fixed buffer of
+	*			INPUT_TEXT_CAPACITY bytes and composition (IME) text to one
+	*			of INPUT_COMPOSITION_CAPACITY, so typing never allocates.
+	*			Update publishes both, and GetText and GetComposition
+	*			return views into them. Text past the capacity is dropped
+	*			(see GetDroppedText), whole characters only. Keys still
+	*			report as usual while text input is on.
+	*/
+	static void StartTextInput();
+
+	/*
+	*	\brief	Stops text input mode, see StartTextInput. Init stops it too.
+	*/
+	static void StopTextInput();
+
+	/*
+	*	\brief	Returns whether text input mode is on
+	*/
+	static bool IsTextInputActive();
+
+	/*
+	*	\brief	Tells the IME where the text being edited is on screen, so
+	*			its candidate list can be placed next to it
+	*/
+	static void SetTextInputRect(int x, int y, int w, int h);
+
+	/*
+	*	\brief	Returns the UTF-8 text committed this frame
+	*/
+	static TextView GetText();
+
+	/*
+	*	\brief	Returns the UTF-8 text the IME is composing, empty when no
+	*			composition is going on
+	*/
+	static TextView GetComposition();
+
+	/*
+	*	\brief	Returns the cursor position in the composition, and the
+	*			length of the selection that starts there, in characters
+	*/
+	static int GetCompositionCursor();
+	static int GetCompositionSelection();
+
+	/*
+	*	\brief	Returns how many bytes of text did not fit in the buffers
+	*			since Init
+	*/
+	static unsigned GetDroppedText();
+
+	/*
+	*	\name	IsTouchTriggered
+	*
+	*	\brief	Returns whether the finger 'finger' touched the screen this
+	*			frame for the first time
+	*
+	*	\detail	Each finger on the screen gets one of INPUT_MAX_FINGERS
+	*			slots (the 'finger' every Touch function takes) for as long
+	*			as it stays down, plus the frame it is released in. SDL
+	*			finger IDs are given keys as events arrive, keys are mapped
+	*			to slots with a small open addressing table and the state
+	*			lives in fixed arrays, so touch events never allocate.
+	*			Fingers past INPUT_MAX_FINGERS are ignored.
+	*			SDL also sends mouse events for touches, with 'which' set
+	*			to SDL_TOUCH_MOUSEID.
+	*/
+	static bool IsTouchTriggered(unsigned finger);
+
+	/*
+	*	\brief	Returns whether the finger 'finger' has been touching the
+	*			screen for longer than the current frame
+	*/
+	static bool IsTouchPressed(unsigned finger);
+
+	/*
+	*	\brief	Returns whether the finger 'finger' left the screen this frame
+	*/
+	static bool IsTouchReleased(unsigned finger);
+
+	/*
+	*	\brief	Returns whether the finger 'finger' moved this frame
+	*/
+	static bool IsTouchMoved(unsigned finger);
+
+	/*
+	*	\brief	Returns how many fingers are touching the screen this frame
+	*/
+	static unsigned GetTouchCount();
+
+	/*
+	*	\brief	Returns the position of the finger 'finger' this frame,
+	*			normalized to [0, 1] over the window
+	*/
+	static float GetTouchX(unsigned finger);
+	static float GetTouchY(unsigned finger);
+
+	/*
+	*	\brief	Returns how far the finger 'finger' moved this frame, every
+	*			motion event since the last frame added up
+	*/
+	static float GetTouchDeltaX(unsigned finger);
+	static float GetTouchDeltaY(unsigned finger);
+
+	/*
+	*	\brief	Returns how hard the finger 'finger' presses, in [0, 1]
+	*/
+	static float GetTouchPressure(unsigned finger);
+
+	/*
+	*	\name	SetTouchGestures
+	*
+	*	\brief	Turns pinch and rotation tracking on or off, it is off
+	*			after Init.
+	*
+	*	\detail	The gesture is worked out by Update from the fingers held
+	*			this frame and the previous one, so it replays like the
+	*			rest of the input. 'aspect' is the width of the window over
+	*			its height, positions are normalized separately on each
+	*			axis and have to be made square again to measure angles.
+	*/
+	static void SetTouchGestures(bool enabled, float aspect = 1.0f);
+
+	/*
+	*	\brief	Returns this frame's gesture, with no fingers when gestures
+	*			are off
+	*/
+	static const TouchGesture & GetTouchGesture();
+
 	/*
 	*	\brief	Returns whether the game pad button 'btn' was pressed for the
 	*			first time this frame on the controller 'which'
@@ -154,6 +641,19 @@ public:
 	*/
 	static bool IsGamePadReleased(unsigned which, SDL_GameControllerButton btn);
 
+	/*
+	*	\brief	Returns the seconds between the last change of the game pad
+	*			button 'btn' on the controller 'which' and the last Update.
+	*			See GetKeyAge.
+	*/
+	static double GetGamePadButtonAge(unsigned which, SDL_GameControllerButton btn);
+
+	/*
+	*	\brief	Returns the seconds between the last motion of the game pad
+	*			axis 'axis' on the controller 'which' and the last Update.
+	*/
+	static double GetGamePadAxisAge(unsigned which, SDL_GameControllerAxis axis);
+
 	/*
 	*	\brief	Returns how pressed the left trigger button is on the controller
 	*			'which'
@@ -191,95 +691,1303 @@ public:
 	static float GamePadRightStickYValue(unsigned which);
 
 	/*
-	*	\brief	Returns a vector containing the ID's of the active (plugged in)
-	*			controllers this frame
+	*	\brief	Returns the filtered value of 'axis' on the controller 'which',
+	*			the same value the functions above return
 	*/
-	static std::vector<unsigned> GetActiveControllers();
+	static float GamePadAxisValue(unsigned which, SDL_GameControllerAxis axis);
 
-private:
+	/*
+	*	\brief	Returns every filtered axis of the controller 'which', all 0
+	*			if there is none
+	*/
+	static Gamepad_Axes GetGamePadAxes(unsigned which);
 
 	/*
-	*	\brief	Handler for Keyboard specific events.
-	*
-	*	\retval	true	The event was a keyboard event.
-	*	\retval false	The event was not a keyboard event.
+	*	\brief	Returns the value of 'axis' on the controller 'which' as the
+	*			device reported it, before any deadzone or curve
 	*/
-	static bool HandleKeyboardEvent(SDL_Event *ev);
-	
+	static float GamePadRawAxisValue(unsigned which, SDL_GameControllerAxis axis);
+
 	/*
-	*	\brief	Handler for Mouse specific events.
+	*	\name	SetStickFilter
 	*
-	*	\retval	true	The event was a mouse event.
-	*	\retval false	The event was not a mouse event.
+	*	\brief	Sets the deadzones and response curve applied to both sticks
+	*			of every controller. See AxisFilter.
+	*
+	*	\detail	Filtering runs once per Update for every controller at once,
+	*			4 controllers per SSE register, so reading a filtered axis
+	*			costs no more than reading a raw one.
 	*/
-	static bool HandleMouseEvent(SDL_Event *ev);
-	
+	static void SetStickFilter(const AxisFilter &filter);
+
 	/*
-	*	\brief	Handler for Gamepad specific events.
-	*
-	*	\retval	true	The event was a gamepad event.
-	*	\retval false	The event was not a gamepad event.
+	*	\brief	Sets the deadzone and response curve applied to both
+	*			triggers of every controller. See SetStickFilter.
 	*/
-	static bool HandleGamePadEvent(SDL_Event *ev);
+	static void SetTriggerFilter(const AxisFilter &filter);
 
 	/*
-	*	\brief	Handler for Keyboard specific events.
-	*
-	*	\retval	true	The event was a keyboard event.
-	*	\retval false	The event was not a keyboard event.
+	*	\brief	Returns the current stick filter
 	*/
-	static void UpdateControllers();
-	
+	static const AxisFilter & GetStickFilter();
+
 	/*
-	*	\brief	Handler for Keyboard specific events.
-	*
-	*	\retval	true	The event was a keyboard event.
-	*	\retval false	The event was not a keyboard event.
+	*	\brief	Returns the current trigger filter
 	*/
-	static void UpdateMouse();
-	
+	static const AxisFilter & GetTriggerFilter();
+
 	/*
-	*	\brief	Handler for Keyboard specific events.
+	*	\name	IsGamePadAxisTriggered
 	*
-	*	\retval	true	The event was a keyboard event.
-	*	\retval false	The event was not a keyboard event.
+	*	\brief	Returns whether the virtual button 'btn' of the controller
+	*			'which' went down this frame.
+	*
+	*	\detail	Each stick direction and trigger is also a button, down
+	*			once its filtered value reaches the press threshold and up
+	*			again once it falls back to the release threshold (see
+	*			SetAxisButtonThresholds), so a stick resting near the
+	*			threshold does not chatter. They go through the same
+	*			ButtonStates as the real buttons, evaluated by Update for
+	*			every controller at once with mask operations on one word
+	*			per controller, and only the ones that changed are set.
 	*/
-	static void UpdateKeyboard();
-	
+	static bool IsGamePadAxisTriggered(unsigned which, AXIS_BTN btn);
+
+	/*
+	*	\brief	Returns whether the virtual button 'btn' of the controller
+	*			'which' has been down for longer than this frame
+	*/
+	static bool IsGamePadAxisPressed(unsigned which, AXIS_BTN btn);
+
 	/*
-	*	\brief	Bitfield for controllers active
+	*	\brief	Returns whether the virtual button 'btn' of the controller
+	*			'which' was down last frame and no longer is
 	*/
-	static std::bitset<INPUT_MAX_CONTROLLERS> controllers_active_;
+	static bool IsGamePadAxisReleased(unsigned which, AXIS_BTN btn);
 
 	/*
-	*	\brief	State of the keyboard last frame
+	*	\brief	Sets the filtered axis values (0 to 1, in the direction of
+	*			'btn') at which 'btn' goes down and back up for every
+	*			controller. 'release' is kept at or below 'press'. Defaults
+	*			are INPUT_AXIS_PRESS and INPUT_AXIS_RELEASE.
 	*/
-	static char kb_prev_[SDL_NUM_SCANCODES];
+	static void SetAxisButtonThresholds(AXIS_BTN btn, float press, float release);
 
 	/*
-	*	\brief	State of the keyboard this frame
+	*	\brief	Returns a vector containing the ID's of the active (plugged in)
+	*			controllers this frame
 	*/
-	static char kb_curr_[SDL_NUM_SCANCODES];
+	static std::vector<unsigned> GetActiveControllers();
 
 	/*
-	*	\brief	State of the mouse the previous frame
+	*	\name	GetControllerSlot
+	*
+	*	\brief	Returns the controller (the 'which' every GamePad function
+	*			takes) used by the SDL joystick instance 'id', or -1.
+	*
+	*	\detail	Controllers are opened and closed as they are plugged in and
+	*			out, and each gets the lowest free slot, so slots stay dense
+	*			and stable for as long as the device stays plugged in. SDL
+	*			instance IDs are never reused, they are mapped to slots with
+	*			an open addressing table, so the lookup done for every game
+	*			pad event is O(1) however many devices come and go.
 	*/
-	static char m_prev_[MOUSE_NUMBTNS];
+	static int GetControllerSlot(SDL_JoystickID id);
 
 	/*
-	*	\brief	State of the mouse this frame
+	*	\brief	Returns the SDL joystick instance ID of the controller 'which',
+	*			or -1 if nothing is plugged in there
 	*/
-	static char m_curr_[MOUSE_NUMBTNS];
-	
+	static SDL_JoystickID GetControllerID(unsigned which);
+
 	/*
-	*	\brief	State of the GamePads last frame
+	*	\brief	Returns the SDL handle of the controller with the instance
+	*			ID 'id', or nullptr. Only call it from the thread pumping
+	*			SDL events, which owns the handles.
 	*/
-	static char gp_prev_[INPUT_MAX_CONTROLLERS][SDL_CONTROLLER_BUTTON_MAX];
-	
+	static SDL_GameController * GetControllerHandle(SDL_JoystickID id);
+
+	/*
+	*	\brief	Returns the event latency histogram of the last Update only
+	*/
+	static const LatencyHistogram & GetFrameLatency();
+
 	/*
-	*	\brief	State of the GamePads this frame
+	*	\brief	Returns the event latency histogram accumulated since Init
+	*			or the last ResetLatency
 	*/
-	static char gp_curr_[INPUT_MAX_CONTROLLERS][SDL_CONTROLLER_BUTTON_MAX];
+	static const LatencyHistogram & GetTotalLatency();
 
-	static Gamepad_Axes gp_axes_[INPUT_MAX_CONTROLLERS];
+	/*
+	*	\brief	Clears the accumulated latency histogram
+	*/
+	static void ResetLatency();
+
+	/*
+	*	\name	BindKey
+	*
+	*	\brief	Makes the keyboard key 'sc' drive 'action'.
+	*
+	*	\detail	An action can have any amount of bindings and is down while
+	*			any of them is. Binding never allocates, the first
+	*			INPUT_MAX_ACTIONS actions and INPUT_MAX_BINDINGS bindings fit.
+	*
+	*	\retval	true	The binding was added.
+	*	\retval false	The action or binding table is full.
+	*/
+	static bool BindKey(ActionID action, SDL_Scancode sc);
+
+	/*
+	*	\brief	Makes the mouse button 'm' drive 'action'. See BindKey.
+	*/
+	static bool BindMouseButton(ActionID action, MOUSE_BTN m);
+
+	/*
+	*	\brief	Makes the game pad button 'btn' of the controller 'which' drive
+	*			'action', any controller when 'which' is negative. See BindKey.
+	*/
+	static bool BindGamePadButton(ActionID action, SDL_GameControllerButton btn, int which = -1);
+
+	/*
+	*	\brief	Makes the game pad axis 'axis' of the controller 'which' drive
+	*			'action', any controller when 'which' is negative. See BindKey.
+	*
+	*	\detail	The action is down while the axis is at or past 'threshold',
+	*			in the direction of its sign (e.g. -0.5 for half way left),
+	*			so 'threshold' should not be 0.
+	*/
+	static bool BindGamePadAxis(ActionID action, SDL_GameControllerAxis axis, float threshold, int which = -1);
+
+	/*
+	*	\brief	Makes the virtual button 'btn' of the controller 'which'
+	*			drive 'action', any controller when 'which' is negative.
+	*			Unlike BindGamePadAxis it has the hysteresis of the virtual
+	*			button, see IsGamePadAxisTriggered.
+	*/
+	static bool BindGamePadAxisButton(ActionID action, AXIS_BTN btn, int which = -1);
+
+	/*
+	*	\brief	Removes every binding of 'action', so it can be bound again.
+	*			Once it has been released (the second Update from now) its
+	*			slot is freed for other actions too, unless a callback is
+	*			subscribed to it or a context consumes it on its own.
+	*/
+	static void UnbindAction(ActionID action);
+
+	/*
+	*	\brief	Removes every action and binding.
+	*
+	*	\detail	Action subscriptions are unsubscribed and contexts stop
+	*			consuming single actions (ConsumeAll still applies to the
+	*			ones added later), as their ActionIDs may get other slots.
+	*			Use UnbindAction to keep them.
+	*/
+	static void ClearActions();
+
+	/*
+	*	\brief	Stores every binding in 'config' as the blob 'name', to be
+	*			saved with the rest of the settings
+	*/
+	static void SaveBindings(ConfigWriter &config, const char *name = "input.bindings");
+
+	/*
+	*	\name	LoadBindings
+	*
+	*	\brief	Replaces every binding with the ones stored in 'config' by
+	*			SaveBindings. Actions keep their slots, so subscriptions
+	*			and ConsumeAction calls made before loading still apply.
+	*			Actions the stored bindings do not use are unbound as by
+	*			UnbindAction.
+	*
+	*	\retval	true	The bindings were loaded.
+	*	\retval false	'config' has no valid bindings called 'name', the
+	*					current ones were left alone.
+	*/
+	static bool LoadBindings(const Config &config, const char *name = "input.bindings");
+
+	/*
+	*	\brief	Returns whether any binding of 'action' went down this frame
+	*			and none was down the previous one
+	*/
+	static bool IsActionTriggered(ActionID action);
+
+	/*
+	*	\brief	Returns whether 'action' has been down for longer than the
+	*			current frame
+	*/
+	static bool IsActionPressed(ActionID action);
+
+	/*
+	*	\brief	Returns whether 'action' was down last frame and no longer is
+	*/
+	static bool IsActionReleased(ActionID action);
+
+	/*
+	*	\name	Query
+	*
+	*	\brief	Evaluates every key and button of 'query' at once.
+	*
+	*	\detail	Equivalent to calling IsKeyTriggered, IsGamePadPressed...
+	*			for each input of the query, but the keyboard and the
+	*			mouse cost an AND per 64 inputs and each controller a few
+	*			more, and only the inputs that are active this frame are
+	*			looked at one by one. Buttons of 'any' controller are set
+	*			when they are set on at least one.
+	*/
+	static void Query(const InputQuery &query, QueryResult &result);
+
+	/*
+	*	\name	CapturePlayerInput
+	*
+	*	\brief	Fills 'input' with this frame's buttons and axes of the
+	*			controller 'which' (none when negative) and every action.
+	*
+	*	\detail	Axes are quantized so that two machines fed the same input
+	*			capture exactly the same bits. Actions are indexed by the
+	*			order they were first bound, bind them in the same order
+	*			on every peer. See InputHistory.
+	*/
+	static void CapturePlayerInput(int which, PlayerInput &input);
+
+	/*
+	*	\brief	Returns whether 'action' is down in 'input'
+	*/
+	static bool IsActionDown(const PlayerInput &input, ActionID action);
+
+	/*
+	*	\brief	Returns the state of the controller 'which' 'frames_ago' frames
+	*			before the last Update (0 for the last Update itself)
+	*
+	*	\retval	true	'frame' was filled.
+	*	\retval false	The history does not go that far back, the last
+	*					INPUT_HISTORY_FRAMES frames since the controller
+	*					was plugged in are kept.
+	*/
+	static bool GetGamePadHistory(unsigned which, unsigned frames_ago, PadFrame &frame);
+
+	/*
+	*	\name	AddCombo
+	*
+	*	\brief	Registers the sequence 'steps', which has to be entered within
+	*			'window' frames from its first step to its last.
+	*
+	*	\detail	Every controller turns its input into symbols once per Update,
+	*			a symbol when its direction changes and one per button
+	*			pressed. All combos are compiled into one deterministic
+	*			automaton (Aho-Corasick) over those symbols, so each symbol
+	*			costs a single table lookup however many combos there are,
+	*			and only the combos completed by it check their window.
+	*			Directions are only sent when they change, so "down, down"
+	*			has to be written as 2, 5, 2. Compiling is done here, not
+	*			per frame, register every combo before play starts.
+	*
+	*	\returns	The combo's index, for IsComboTriggered, or -1 if there
+	*				are INPUT_MAX_COMBOS already or the combo is longer than
+	*				INPUT_COMBO_MAX_SYMBOLS symbols.
+	*/
+	static int AddCombo(const ComboStep *steps, unsigned count, unsigned window);
+
+	/*
+	*	\brief	Removes every combo
+	*/
+	static void ClearCombos();
+
+	/*
+	*	\brief	Returns whether the controller 'which' completed the combo
+	*			'combo' this frame
+	*/
+	static bool IsComboTriggered(unsigned which, unsigned combo);
+
+	/*
+	*	\brief	Mirrors left and right for the combos of the controller
+	*			'which', so 6 means forward while the player faces left
+	*/
+	static void SetComboMirrored(unsigned which, bool mirrored);
+
+	/*
+	*	\name	AssignController
+	*
+	*	\brief	Gives the controller 'which' to 'player' (0 to
+	*			INPUT_MAX_PLAYERS - 1), taking it from whoever had it, and
+	*			joins 'player' if it had not joined yet.
+	*
+	*	\detail	Players own their devices by instance ID, so a player
+	*			keeps its controller wherever the slot of the controller
+	*			moves, and loses it once it is unplugged. Once per Update
+	*			every player's devices are resolved and its actions are
+	*			evaluated against them only, so the IsPlayer* queries
+	*			below cost the same as the global ones however many
+	*			players there are.
+	*
+	*	\retval	true	The controller was assigned.
+	*	\retval false	'player' is out of range or nothing is plugged
+	*					into 'which'.
+	*/
+	static bool AssignController(unsigned player, unsigned which);
+
+	/*
+	*	\brief	Gives the keyboard and mouse to 'player', taking them from
+	*			whoever had them. See AssignController.
+	*/
+	static bool AssignKeyboard(unsigned player);
+
+	/*
+	*	\brief	Takes every device from 'player' and leaves its seat free
+	*/
+	static void RemovePlayer(unsigned player);
+
+	/*
+	*	\name	SetJoinOnPress
+	*
+	*	\brief	Lets devices join by themselves, off after Init.
+	*
+	*	\detail	While on, pressing any button of a controller no player
+	*			owns gives it to the first joined player whose controller
+	*			was unplugged, or else seats a new player in the first free
+	*			seat. Pressing a key or mouse button does the same for the
+	*			keyboard. See HasPlayerJoined.
+	*/
+	static void SetJoinOnPress(bool enabled);
+
+	/*
+	*	\brief	Returns whether 'player' has joined
+	*/
+	static bool IsPlayerJoined(unsigned player);
+
+	/*
+	*	\brief	Returns whether 'player' joined this frame
+	*/
+	static bool HasPlayerJoined(unsigned player);
+
+	/*
+	*	\brief	Returns the controller (slot) of 'player' this frame, or -1
+	*/
+	static int GetPlayerController(unsigned player);
+
+	/*
+	*	\brief	Returns whether 'player' owns the keyboard and mouse
+	*/
+	static bool HasPlayerKeyboard(unsigned player);
+
+	/*
+	*	\brief	Returns the player that owns the controller 'which', or -1
+	*/
+	static int GetControllerPlayer(unsigned which);
+
+	/*
+	*	\brief	Returns whether a binding of 'action' on one of the devices
+	*			of 'player' went down this frame and none was down the
+	*			previous one. Game pad bindings for any controller stand
+	*			for the player's own controller.
+	*/
+	static bool IsPlayerActionTriggered(unsigned player, ActionID action);
+
+	/*
+	*	\brief	Returns whether 'action' has been down for 'player' for
+	*			longer than the current frame
+	*/
+	static bool IsPlayerActionPressed(unsigned player, ActionID action);
+
+	/*
+	*	\brief	Returns whether 'action' was down for 'player' last frame
+	*			and no longer is
+	*/
+	static bool IsPlayerActionReleased(unsigned player, ActionID action);
+
+	/*
+	*	\brief	Game pad queries on the controller of 'player', false or 0
+	*			if it has none. See IsGamePadTriggered.
+	*/
+	static bool IsPlayerButtonTriggered(unsigned player, SDL_GameControllerButton btn);
+	static bool IsPlayerButtonPressed(unsigned player, SDL_GameControllerButton btn);
+	static bool IsPlayerButtonReleased(unsigned player, SDL_GameControllerButton btn);
+	static float PlayerAxisValue(unsigned player, SDL_GameControllerAxis axis);
+
+	/*
+	*	\name	SubscribeKey
+	*
+	*	\brief	Calls 'callback' from Update every frame the key 'sc' goes
+	*			down or up, instead of polling it every frame.
+	*
+	*	\detail	Subscribers only cost anything on frames where what they
+	*			subscribed to changes: at the end of Update the keys and
+	*			buttons that changed are taken from the dirty lists of
+	*			their states and looked up in a flat table of subscriptions
+	*			kept sorted by input. The callbacks are Delegates, stored in
+	*			the table, so neither subscribing nor dispatching
+	*			allocates. Callbacks run after every other state of the
+	*			frame is final, in the order they subscribed, and may
+	*			subscribe and unsubscribe (new subscriptions start with the
+	*			next frame).
+	*
+	*	\returns	The handle to Unsubscribe with, 0 if INPUT_MAX_SUBSCRIPTIONS
+	*				are taken.
+	*/
+	static SubscriptionID SubscribeKey(SDL_Scancode sc, const InputCallback &callback);
+
+	/*
+	*	\brief	Same as SubscribeKey for the mouse button 'm'
+	*/
+	static SubscriptionID SubscribeMouseButton(MOUSE_BTN m, const InputCallback &callback);
+
+	/*
+	*	\brief	Same as SubscribeKey for the button 'btn' of the controller
+	*			'which', -1 for any controller
+	*/
+	static SubscriptionID SubscribeGamePadButton(SDL_GameControllerButton btn, const InputCallback &callback, int which = -1);
+
+	/*
+	*	\brief	Same as SubscribeKey for the global state of 'action' (see
+	*			IsActionTriggered)
+	*/
+	static SubscriptionID SubscribeAction(ActionID action, const InputCallback &callback);
+
+	/*
+	*	\brief	Stops calling the callback of 'id' right away
+	*/
+	static void Unsubscribe(SubscriptionID id);
+
+	/*
+	*	\brief	Unsubscribes everything
+	*/
+	static void UnsubscribeAll();
+
+	/*
+	*	\name	PushContext
+	*
+	*	\brief	Puts the input context 'ctx' (0 to INPUT_MAX_CONTEXTS - 1,
+	*			numbered by the game, e.g. gameplay, menu, console) on top
+	*			of the context stack, moving it there if it already was on
+	*			it.
+	*
+	*	\detail	Each context declares what it consumes with the Consume*
+	*			functions, and every context below it sees those inputs as
+	*			idle through the IsContext* queries. Update (and every
+	*			change to the stack or to what a context consumes) turns
+	*			the stack into one visibility mask per context, so those
+	*			queries are the plain query ANDed with a mask bit. Actions
+	*			are hidden when they are consumed, or when only consumed
+	*			inputs hold them down, so a key typed into a console does
+	*			not fire the gameplay action bound to it. Contexts that are
+	*			not on the stack see nothing at all. The stack is emptied
+	*			by Init, what each context consumes is kept.
+	*
+	*	\retval	true	'ctx' is on top.
+	*	\retval false	'ctx' is out of range.
+	*/
+	static bool PushContext(unsigned ctx);
+
+	/*
+	*	\brief	Takes 'ctx' off the stack, wherever it is
+	*/
+	static void PopContext(unsigned ctx);
+
+	/*
+	*	\brief	Returns whether 'ctx' is on the stack
+	*/
+	static bool IsContextActive(unsigned ctx);
+
+	/*
+	*	\brief	Makes 'ctx' consume (or stop consuming) an input, see
+	*			PushContext
+	*/
+	static void ConsumeKey(unsigned ctx, SDL_Scancode sc, bool consume = true);
+	static void ConsumeMouseButton(unsigned ctx, MOUSE_BTN m, bool consume = true);
+	static void ConsumeGamePadButton(unsigned ctx, SDL_GameControllerButton btn, bool consume = true);
+	static void ConsumeGamePadAxis(unsigned ctx, SDL_GameControllerAxis axis, bool consume = true);
+	static void ConsumeAction(unsigned ctx, ActionID action, bool consume = true);
+
+	/*
+	*	\brief	Makes 'ctx' consume every key, button, axis and action, or
+	*			none of them
+	*/
+	static void ConsumeAll(unsigned ctx, bool consume = true);
+
+	/*
+	*	\brief	Queries for what 'ctx' sees, see PushContext and the
+	*			queries they are named after
+	*/
+	static bool IsContextKeyTriggered(unsigned ctx, SDL_Scancode sc);
+	static bool IsContextKeyPressed(unsigned ctx, SDL_Scancode sc);
+	static bool IsContextKeyReleased(unsigned ctx, SDL_Scancode sc);
+	static bool IsContextMouseButtonTriggered(unsigned ctx, MOUSE_BTN m);
+	static bool IsContextMouseButtonPressed(unsigned ctx, MOUSE_BTN m);
+	static bool IsContextMouseButtonReleased(unsigned ctx, MOUSE_BTN m);
+	static bool IsContextGamePadTriggered(unsigned ctx, unsigned which, SDL_GameControllerButton btn);
+	static bool IsContextGamePadPressed(unsigned ctx, unsigned which, SDL_GameControllerButton btn);
+	static bool IsContextGamePadReleased(unsigned ctx, unsigned which, SDL_GameControllerButton btn);
+	static float ContextGamePadAxisValue(unsigned ctx, unsigned which, SDL_GameControllerAxis axis);
+	static bool IsContextActionTriggered(unsigned ctx, ActionID action);
+	static bool IsContextActionPressed(unsigned ctx, ActionID action);
+	static bool IsContextActionReleased(unsigned ctx, ActionID action);
+
+	/*
+	*	\name	GetKeyHoldTime
+	*
+	*	\brief	Returns the seconds the key 'sc' has been down up to the
+	*			last Update, 0 while it is up.
+	*
+	*	\detail	Every button state keeps, next to its bits, the times
+	*			its button last went down and up and the time it went
+	*			down before that, taken from the events themselves. Hold,
+	*			double tap and repeat queries are a subtraction and a
+	*			compare on those, for every key, button and action,
+	*			without any tracking on the game's side.
+	*/
+	static double GetKeyHoldTime(SDL_Scancode sc);
+
+	/*
+	*	\brief	Returns whether the key 'sc' has been down for 'seconds'
+	*			or longer
+	*/
+	static bool IsKeyHeld(SDL_Scancode sc, double seconds);
+
+	/*
+	*	\brief	Returns whether the key 'sc' went down this frame no more
+	*			than 'window' seconds after it last went down. A third tap
+	*			in a row counts again.
+	*/
+	static bool IsKeyDoubleTapped(SDL_Scancode sc, double window = INPUT_DOUBLE_TAP_WINDOW);
+
+	/*
+	*	\brief	Returns whether the key 'sc' went down this frame, or has
+	*			been held for 'delay' seconds and then every 'interval'
+	*			seconds since then, like a text cursor moves. True at most
+	*			once per frame.
+	*/
+	static bool IsKeyRepeated(SDL_Scancode sc, double delay = INPUT_REPEAT_DELAY, double interval = INPUT_REPEAT_INTERVAL);
+
+	/*
+	*	\brief	Same as the key versions, for the mouse button 'm'
+	*/
+	static double GetMouseButtonHoldTime(MOUSE_BTN m);
+	static bool IsMouseButtonHeld(MOUSE_BTN m, double seconds);
+	static bool IsMouseButtonDoubleTapped(MOUSE_BTN m, double window = INPUT_DOUBLE_TAP_WINDOW);
+	static bool IsMouseButtonRepeated(MOUSE_BTN m, double delay = INPUT_REPEAT_DELAY, double interval = INPUT_REPEAT_INTERVAL);
+
+	/*
+	*	\brief	Same as the key versions, for the button 'btn' of the
+	*			controller 'which'
+	*/
+	static double GetGamePadHoldTime(unsigned which, SDL_GameControllerButton btn);
+	static bool IsGamePadHeld(unsigned which, SDL_GameControllerButton btn, double seconds);
+	static bool IsGamePadDoubleTapped(unsigned which, SDL_GameControllerButton btn, double window = INPUT_DOUBLE_TAP_WINDOW);
+	static bool IsGamePadRepeated(unsigned which, SDL_GameControllerButton btn, double delay = INPUT_REPEAT_DELAY, double interval = INPUT_REPEAT_INTERVAL);
+
+	/*
+	*	\brief	Same as the key versions, for the global state of 'action'.
+	*			Actions change on Update, so their times are frame times.
+	*/
+	static double GetActionHoldTime(ActionID action);
+	static bool IsActionHeld(ActionID action, double seconds);
+	static bool IsActionDoubleTapped(ActionID action, double window = INPUT_DOUBLE_TAP_WINDOW);
+	static bool IsActionRepeated(ActionID action, double delay = INPUT_REPEAT_DELAY, double interval = INPUT_REPEAT_INTERVAL);
+
+private:
+
+	enum BINDING_TYPE : Uint8
+	{
+		BIND_KEY,
+		BIND_MOUSE_BUTTON,
+		BIND_GAMEPAD_BUTTON,
+		BIND_GAMEPAD_AXIS,
+		BIND_GAMEPAD_AXIS_BUTTON
+	};
+
+	/*
+	*	\brief	One entry of the flat binding table
+	*/
+	struct Binding
+	{
+		Uint8 slot;			//index of the action in action_ids_
+		Uint8 type;			//BINDING_TYPE
+		Sint16 which;		//controller, -1 for any
+		Uint16 code;		//scancode, button or axis
+		float threshold;	//only for BIND_GAMEPAD_AXIS
+	};
+
+	/*
+	*	\brief	Finds the slot of 'action', adding it if 'add' is set.
+	*
+	*	\returns	The slot, or INPUT_MAX_ACTIONS if there is none.
+	*/
+	static unsigned FindAction(ActionID action, bool add);
+
+	/*
+	*	\brief	Whether a subscription or a context refers to the action
+	*			slot 'slot', so it has to stay allocated
+	*/
+	static bool IsActionReferenced(unsigned slot);
+
+	/*
+	*	\brief	Removes the entry 'i' of the action table and hands its
+	*			slot back, with every state kept for it cleared
+	*/
+	static void FreeAction(unsigned i);
+
+	/*
+	*	\brief	Frees the slots of the actions unbound before the last
+	*			Update that nothing refers to any more
+	*/
+	static void FreeUnboundActions();
+
+	/*
+	*	\brief	Appends a binding for 'action' to the table
+	*/
+	static bool AddBinding(ActionID action, BINDING_TYPE type, unsigned code, int which, float threshold);
+
+	/*
+	*	\brief	Evaluates every binding against this frame's device state
+	*			and advances the action state machine.
+	*/
+	static void UpdateActions();
+
+	/*
+	*	\brief	Returns whether 'b' is down on the controllers in
+	*			[first_pad, last_pad), or on the keyboard and mouse if
+	*			'keyboard' is set
+	*/
+	static bool IsBindingDown(const Binding &b, unsigned first_pad, unsigned last_pad, bool keyboard);
+
+	/*
+	*	\brief	Hands 'states' the actions whose 'down' bit changed and
+	*			advances it
+	*/
+	static void SetActions(ButtonStates<INPUT_MAX_ACTIONS> &states, const InputBits<INPUT_MAX_ACTIONS> &down);
+
+	/*
+	*	\brief	Devices and action state of one player. 'pad' is the slot
+	*			of 'pad_id' this frame, resolved by UpdatePlayers.
+	*/
+	struct Player
+	{
+		bool joined;
+		bool keyboard;
+		SDL_JoystickID pad_id;
+		int pad;
+		ButtonStates<INPUT_MAX_ACTIONS> actions;
+	};
+
+	/*
+	*	\brief	Resolves the devices of every player, seats the devices
+	*			that asked to join and evaluates each player's actions.
+	*/
+	static void UpdatePlayers();
+
+	/*
+	*	\brief	Seats the devices pressed this frame that no player owns
+	*/
+	static void JoinOnPress();
+
+	/*
+	*	\brief	Marks 'player' as joined, returns false if it already was
+	*/
+	static bool JoinPlayer(unsigned player);
+
+	/*
+	*	\brief	One bit per input of each kind, for what a context consumes
+	*			or sees
+	*/
+	struct ContextMasks
+	{
+		InputBits<SDL_NUM_SCANCODES> keys;
+		InputBits<MOUSE_NUMBTNS + 1> mouse;
+		InputBits<SDL_CONTROLLER_BUTTON_MAX> buttons;
+		InputBits<SDL_CONTROLLER_AXIS_MAX> axes;
+		InputBits<INPUT_MAX_ACTIONS> actions;
+	};
+
+	/*
+	*	\brief	Rolls the action masks over to a new frame and recomputes
+	*			every mask
+	*/
+	static void UpdateContexts();
+
+	/*
+	*	\brief	Turns the stack and what each context consumes into what
+	*			each context sees
+	*/
+	static void ComputeContextMasks();
+
+	/*
+	*	\brief	Returns whether the input of 'b' is visible in 'visible'
+	*/
+	static bool IsBindingVisible(const Binding &b, const ContextMasks &visible);
+
+	/*
+	*	\brief	One entry of the subscription table. 'key' packs the
+	*			EVENT_TYPE, the controller and the scancode, button or
+	*			action slot, see SubscriptionKey. 'id' is 0 once
+	*			unsubscribed.
+	*/
+	struct Subscription
+	{
+		Uint32 key;
+		SubscriptionID id;
+		Uint32 code;
+		InputCallback callback;
+	};
+
+	static Uint32 SubscriptionKey(EVENT_TYPE type, int which, unsigned code);
+
+	/*
+	*	\brief	Appends a subscription, it is sorted into the table by the
+	*			next DispatchEvents
+	*/
+	static SubscriptionID Subscribe(EVENT_TYPE type, int which, unsigned code, Uint32 event_code, const InputCallback &callback);
+
+	/*
+	*	\brief	Drops the entries unsubscribed and sorts the new ones in
+	*/
+	static void SortSubscriptions();
+
+	/*
+	*	\brief	Calls the subscribers of everything that changed this frame
+	*/
+	static void DispatchEvents();
+
+	template <unsigned Bits>
+	static void DispatchChanges(const ButtonStates<Bits> &states, EVENT_TYPE type, int which);
+
+	/*
+	*	\brief	Calls the subscribers of 'code' on the controller 'which'
+	*			(and of any controller)
+	*/
+	static void Notify(EVENT_TYPE type, int which, unsigned code, bool down);
+
+	/*
+	*	\brief	Combo and history state of one controller
+	*/
+	struct ComboTracker
+	{
+		PadFrame history[INPUT_HISTORY_FRAMES];
+		unsigned frames;			//frames in 'history', up to INPUT_HISTORY_FRAMES
+		Uint64 symbol_frames[INPUT_COMBO_MAX_SYMBOLS];	//frame of the last symbols
+		Uint64 symbols;				//symbols fed so far
+		Uint16 state;				//automaton state
+		Uint8 direction;			//last direction fed
+		bool mirrored;
+		InputBits<INPUT_MAX_COMBOS> triggered;
+	};
+
+	/*
+	*	\brief	Adds this frame to the history of every controller and feeds
+	*			its symbols to the combo automaton.
+	*/
+	static void UpdateCombos();
+
+	/*
+	*	\brief	Builds the automaton for every registered combo
+	*/
+	static void CompileCombos();
+
+	/*
+	*	\brief	Opens the controller at the SDL device index 'device', unless
+	*			it is open already. Only called from the thread that pumps
+	*			SDL events.
+	*
+	*	\returns	The joystick instance ID of the controller, or -1.
+	*/
+	static SDL_JoystickID OpenController(int device);
+
+	/*
+	*	\brief	Closes the controller with the instance ID 'id'. Only called
+	*			from the thread that pumps SDL events.
+	*/
+	static void CloseController(SDL_JoystickID id);
+
+	/*
+	*	\brief	Gives the instance ID 'id' the lowest free slot, growing the
+	*			controller storage if every slot is taken
+	*/
+	static void AddController(SDL_JoystickID id);
+
+	/*
+	*	\brief	Frees the slot of the instance ID 'id'. Buttons it held are
+	*			released as of 'when' and its axes go back to rest.
+	*/
+	static void RemoveController(SDL_JoystickID id, Uint64 when);
+
+	/*
+	*	\brief	Resizes every per controller array to 'capacity' slots and
+	*			rebuilds the instance ID table to match
+	*/
+	static void GrowControllers(unsigned capacity);
+
+	/*
+	*	\brief	Sets and advances the virtual axis buttons of every
+	*			controller from the filtered axes
+	*/
+	static void UpdateAxisButtons();
+
+	/*
+	*	\brief	Returns the axis the virtual button 'btn' reads
+	*/
+	static SDL_GameControllerAxis GetAxisOfButton(unsigned btn);
+
+	/*
+	*	\brief	Fills 'rec' with the input relevant part of 'ev'.
+	*
+	*	\retval	true	The event was input related.
+	*	\retval false	The event was not input related, or is a finger event
+	*					MakeTouchRecord drops.
+	*/
+	static bool MakeRecord(const SDL_Event *ev, Record &rec);
+
+	/*
+	*	\brief	Sets the timestamps of 'rec' from the SDL timestamp
+	*			'timestamp'
+	*/
+	static void StampRecord(Record &rec, Uint32 timestamp);
+
+	/*
+	*	\brief	Applies 'rec' right away or queues it, depending on the mode
+	*/
+	static void SubmitRecord(const Record &rec);
+
+	/*
+	*	\brief	Splits a text or composition event into records and
+	*			submits them.
+	*/
+	static void SubmitText(const SDL_Event *ev);
+
+	/*
+	*	\brief	Changes the current state according to 'rec'.
+	*/
+	static void ApplyRecord(const Record &rec);
+
+	/*
+	*	\brief	Adds the age of every record applied since the last frame
+	*			to the latency histograms.
+	*/
+	static void UpdateLatency();
+
+	/*
+	*	\brief	Copies this frame's state into a free snapshot and makes it
+	*			the one AcquireSnapshot returns.
+	*/
+	static void PublishSnapshot();
+
+	/*
+	*	\brief	Converts a SDL_GetPerformanceCounter interval to seconds
+	*/
+	static double CounterToSeconds(Uint64 counter);
+	static Uint64 SecondsToCounter(double seconds);
+
+	/*
+	*	\brief	Handler for Keyboard specific events.
+	*
+	*	\retval	true	The event was a keyboard event.
+	*	\retval false	The event was not a keyboard event.
+	*/
+	static bool HandleKeyboardEvent(const Record &rec);
+	
+	/*
+	*	\brief	Handler for Mouse specific events.
+	*
+	*	\retval	true	The event was a mouse event.
+	*	\retval false	The event was not a mouse event.
+	*/
+	static bool HandleMouseEvent(const Record &rec);
+	
+	/*
+	*	\brief	Handler for text and composition records.
+	*
+	*	\retval	true	The record was a text record.
+	*	\retval false	The record was not a text record.
+	*/
+	static bool HandleTextEvent(const Record &rec);
+
+	/*
+	*	\brief	Publishes the text and composition of this frame
+	*/
+	static void UpdateText();
+
+	/*
+	*	\name	MakeTouchRecord
+	*
+	*	\brief	Fills 'rec' with a finger event.
+	*
+	*	\detail	SDL's touch and finger IDs are 64 bits each and the record
+	*			has 32 for both, so each finger gets a key of its own when
+	*			it goes down, unique among the fingers down, and keeps it
+	*			until it is lifted. Keys are handed out here, on the thread
+	*			calling HandleEvent, so they are logged and replayed too.
+	*
+	*	\retval	true	'rec' holds the event.
+	*	\retval	false	The event is dropped: the finger went down before
+	*					Init, or INPUT_MAX_FINGERS fingers already are.
+	*/
+	static bool MakeTouchRecord(const SDL_TouchFingerEvent &ev, Record &rec);
+
+	/*
+	*	\brief	Handler for finger records.
+	*
+	*	\retval	true	The record was a touch record.
+	*	\retval false	The record was not a touch record.
+	*/
+	static bool HandleTouchEvent(const Record &rec);
+
+	/*
+	*	\brief	Returns the slot of the finger 'id', or -1
+	*/
+	static int FindFinger(Sint32 id);
+
+	/*
+	*	\brief	Gives the finger 'id' a free slot and returns it, or -1 if
+	*			every slot is taken
+	*/
+	static int AddFinger(Sint32 id);
+
+	/*
+	*	\brief	Removes the finger 'id' from the table, its slot stays
+	*			taken until Update has reported it released
+	*/
+	static void RemoveFinger(Sint32 id);
+
+	/*
+	*	\brief	Publishes the fingers of this frame and works out the
+	*			gesture
+	*/
+	static void UpdateTouch();
+
+	/*
+	*	\brief	Handler for Gamepad specific events.
+	*
+	*	\retval	true	The event was a gamepad event.
+	*	\retval false	The event was not a gamepad event.
+	*/
+	static bool HandleGamePadEvent(const Record &rec);
+
+	/*
+	*	\brief	Handler for Keyboard specific events.
+	*
+	*	\retval	true	The event was a keyboard event.
+	*	\retval false	The event was not a keyboard event.
+	*/
+	static void UpdateControllers();
+	
+	/*
+	*	\brief	Handler for Keyboard specific events.
+	*
+	*	\retval	true	The event was a keyboard event.
+	*	\retval false	The event was not a keyboard event.
+	*/
+	static void UpdateMouse();
+	
+	/*
+	*	\brief	Handler for Keyboard specific events.
+	*
+	*	\retval	true	The event was a keyboard event.
+	*	\retval false	The event was not a keyboard event.
+	*/
+	static void UpdateKeyboard();
+	
+
+	/*
+	*	\brief	State of the keyboard, one bit per scancode
+	*/
+	static ButtonStates<SDL_NUM_SCANCODES> kb_;
+
+	/*
+	*	\brief	State of the mouse, indexed by MOUSE_BTN
+	*/
+	static ButtonStates<MOUSE_NUMBTNS + 1> m_;
+	
+	/*
+	*	\brief	State of the GamePads, one per slot, indexed by
+	*			SDL_GameControllerButton. Every per controller array has
+	*			the same size, always a multiple of 4.
+	*/
+	static std::vector<ButtonStates<SDL_CONTROLLER_BUTTON_MAX>> gp_;
+
+	/*
+	*	\brief	GamePad axes as reported, normalized to [-1, 1], one array
+	*			per SDL_GameControllerAxis so each holds every controller
+	*/
+	static std::vector<float> gp_raw_axes_[SDL_CONTROLLER_AXIS_MAX];
+
+	/*
+	*	\brief	GamePad axes after filtering, same layout as gp_raw_axes_
+	*/
+	static std::vector<float> gp_axes_[SDL_CONTROLLER_AXIS_MAX];
+
+	/*
+	*	\brief	When each game pad axis last moved
+	*/
+	static std::vector<Uint64> gp_axes_time_[SDL_CONTROLLER_AXIS_MAX];
+
+	/*
+	*	\brief	Virtual axis buttons of each controller slot and their
+	*			thresholds, see IsGamePadAxisTriggered
+	*/
+	static std::vector<ButtonStates<AXIS_NUMBTNS>> gp_axis_btns_;
+	static float axis_btn_press_[AXIS_NUMBTNS];
+	static float axis_btn_release_[AXIS_NUMBTNS];
+
+	/*
+	*	\brief	Instance ID plugged into each slot, -1 for free slots
+	*/
+	static std::vector<SDL_JoystickID> gp_slot_ids_;
+	static unsigned gp_count_;
+
+	/*
+	*	\brief	Slots freed since the last Update. They still hold the
+	*			release of whatever was down on the unplugged controller,
+	*			so they are not handed out again before it is applied.
+	*/
+	static std::vector<unsigned> gp_retired_;
+
+	/*
+	*	\brief	Open addressing table from instance ID to slot, at least
+	*			twice as big as gp_slot_ids_ and a power of two. -1 marks
+	*			empty entries.
+	*/
+	static std::vector<SDL_JoystickID> gp_table_ids_;
+	static std::vector<unsigned> gp_table_slots_;
+
+	/*
+	*	\brief	SDL handles of the open controllers, owned by the thread
+	*			pumping SDL events
+	*/
+	static std::vector<SDL_GameController *> gp_handles_;
+
+	static AxisFilter stick_filter_;
+	static AxisFilter trigger_filter_;
+
+	/*
+	*	\brief	Mouse position, motion and wheel. Motion and wheel events are
+	*			added into 'live' as they come, Update copies it into
+	*			'frame' and starts accumulating again.
+	*/
+	struct MouseMotion
+	{
+		int x;
+		int y;
+		int dx;
+		int dy;
+		int wheel_x;
+		int wheel_y;
+	};
+
+	static MouseMotion m_live_;
+	static MouseMotion m_frame_;
+
+	/*
+	*	\brief	Text and composition, appended to in 'live' as records come
+	*			and copied to 'frame' by Update, like the mouse motion
+	*/
+	struct TextBuffer
+	{
+		char text[INPUT_TEXT_CAPACITY];
+		unsigned text_size;
+		char composition[INPUT_COMPOSITION_CAPACITY];
+		unsigned composition_size;
+		int cursor;
+		int selection;
+		bool overflow;
+	};
+
+	static TextBuffer text_live_;
+	static TextBuffer text_frame_;
+	static unsigned text_dropped_;
+
+	/*
+	*	\brief	State of the touch screen, one bit per finger slot
+	*/
+	static ButtonStates<INPUT_MAX_FINGERS> touch_;
+
+	/*
+	*	\brief	Position of each finger slot. Motion is added into 'live'
+	*			as it comes and copied to 'frame' by Update, like the mouse.
+	*/
+	struct TouchFinger
+	{
+		float x;
+		float y;
+		float dx;
+		float dy;
+		float pressure;
+	};
+
+	static TouchFinger touch_live_[INPUT_MAX_FINGERS];
+	static TouchFinger touch_frame_[INPUT_MAX_FINGERS];
+	static InputBits<INPUT_MAX_FINGERS> touch_moved_live_;
+	static InputBits<INPUT_MAX_FINGERS> touch_moved_;
+
+	/*
+	*	\brief	Open addressing table from finger ID to slot, twice as big
+	*			as the pool. Entries hold a slot, or INPUT_MAX_FINGERS when
+	*			empty, the ID of each slot is in touch_ids_.
+	*/
+	static Uint8 touch_table_[INPUT_MAX_FINGERS * 2];
+	static Sint32 touch_ids_[INPUT_MAX_FINGERS];
+
+	/*
+	*	\brief	Key of each finger down, as the thread calling HandleEvent
+	*			sees them, see MakeTouchRecord. Only that thread uses them.
+	*/
+	struct TouchKey
+	{
+		SDL_TouchID touch;
+		SDL_FingerID finger;
+		Sint32 key;
+	};
+
+	static TouchKey touch_keys_[INPUT_MAX_FINGERS];
+	static unsigned touch_key_count_;
+	static Uint32 touch_next_key_;
+
+	static bool touch_gestures_;
+	static float touch_aspect_;
+	static TouchGesture touch_gesture_;
+
+	/*
+	*	\brief	SDL_GetPerformanceCounter at the last Update and its frequency
+	*/
+	static Uint64 frame_time_;
+	static Uint64 counter_freq_;
+	static Uint64 prev_frame_time_;	//frame_time_ of the Update before
+
+	/*
+	*	\brief	frame_time_ of the next Update, if InjectFrameTime set one
+	*/
+	static Uint64 injected_time_;
+	static bool time_injected_;
+
+	/*
+	*	\brief	Updates run since Init
+	*/
+	static Uint64 frame_count_;
+
+	/*
+	*	\brief	Counters of the records applied since the last Update
+	*/
+	static Uint64 pending_[INPUT_LATENCY_SAMPLES];
+	static unsigned pending_count_;
+	static unsigned pending_dropped_;
+
+	static LatencyHistogram frame_latency_;
+	static LatencyHistogram total_latency_;
+
+	/*
+	*	\brief	Whether HandleEvent queues records instead of applying them
+	*/
+	static bool deferred_;
+
+	/*
+	*	\brief	Records handed from the event pump to Update
+	*/
+	static SPSCQueue<Record, INPUT_QUEUE_SIZE> queue_;
+
+	/*
+	*	\brief	Records that did not fit in queue_
+	*/
+	static std::atomic<unsigned> dropped_;
+
+	/*
+	*	\brief	Where applied records are logged, if anywhere
+	*/
+	static InputRecorder *recorder_;
+
+	/*
+	*	\brief	Snapshot buffers and the published one
+	*/
+	static InputSnapshot snapshots_[INPUT_SNAPSHOT_POOL];
+	static std::atomic<InputSnapshot *> snapshot_;
+
+	/*
+	*	\brief	Open addressing table from ActionID to slot. Sized to twice
+	*			INPUT_MAX_ACTIONS, so probes are short.
+	*/
+	static ActionID action_ids_[INPUT_MAX_ACTIONS * 2];
+	static Uint8 action_slots_[INPUT_MAX_ACTIONS * 2];
+	static unsigned action_count_;	//slots ever handed out
+
+	/*
+	*	\brief	Slots below action_count_ freed by UnbindAction, reused
+	*			first
+	*/
+	static Uint8 action_free_[INPUT_MAX_ACTIONS];
+	static unsigned action_free_count_;
+
+	/*
+	*	\brief	Slots of the actions UnbindAction left without bindings,
+	*			freed once their release has been seen
+	*/
+	static InputBits<INPUT_MAX_ACTIONS> action_unbound_;
+
+	/*
+	*	\brief	Flat binding table, evaluated once per Update
+	*/
+	static Binding bindings_[INPUT_MAX_BINDINGS];
+	static unsigned binding_count_;
+
+	/*
+	*	\brief	Bindings down as of the last Update, indexed like bindings_
+	*/
+	static InputBits<INPUT_MAX_BINDINGS> bindings_down_;
+
+	/*
+	*	\brief	State of every action, indexed by slot
+	*/
+	static ButtonStates<INPUT_MAX_ACTIONS> actions_;
+
+	/*
+	*	\brief	Registered combos, as symbols
+	*/
+	static Uint8 combo_symbols_[INPUT_MAX_COMBOS][INPUT_COMBO_MAX_SYMBOLS];
+	static Uint8 combo_lengths_[INPUT_MAX_COMBOS];
+	static unsigned combo_windows_[INPUT_MAX_COMBOS];
+	static unsigned combo_count_;
+
+	/*
+	*	\brief	Combo automaton, a row of next states per state and the
+	*			combos that end at each state
+	*/
+	static std::vector<Uint16> combo_next_;
+	static std::vector<InputBits<INPUT_MAX_COMBOS>> combo_ends_;
+
+	/*
+	*	\brief	Combo and history state, one per controller slot
+	*/
+	static std::vector<ComboTracker> gp_combos_;
+
+	static Player players_[INPUT_MAX_PLAYERS];
+	static bool join_on_press_;
+	static Uint32 players_joined_;	//bit per player that joined this frame
+
+	/*
+	*	\brief	Subscription table, the first subs_sorted_ entries sorted
+	*			by key and the ones subscribed since the last sort after
+	*			them
+	*/
+	static Subscription subs_[INPUT_MAX_SUBSCRIPTIONS];
+	static unsigned sub_count_;
+	static unsigned subs_sorted_;
+	static unsigned subs_dead_;
+	static Uint32 sub_types_;			//bit per EVENT_TYPE with subscribers
+	static SubscriptionID next_sub_id_;
+	static bool dispatching_;
+
+	static ContextMasks ctx_consumed_[INPUT_MAX_CONTEXTS];
+	static ContextMasks ctx_visible_[INPUT_MAX_CONTEXTS];
+
+	/*
+	*	\brief	Whether each context was last told to ConsumeAll, which is
+	*			what an action slot handed out again starts as
+	*/
+	static bool ctx_consume_all_[INPUT_MAX_CONTEXTS];
+
+	/*
+	*	\brief	Actions each context saw last frame, so an action released
+	*			this frame is only seen released where it was seen down
+	*/
+	static InputBits<INPUT_MAX_ACTIONS> ctx_actions_prev_[INPUT_MAX_CONTEXTS];
+
+	/*
+	*	\brief	Contexts on the stack, bottom first
+	*/
+	static Uint8 ctx_stack_[INPUT_MAX_CONTEXTS];
+	static unsigned ctx_depth_;
 };
\ No newline at end of file
@@ -0,0 +1,432 @@
+#include "JBEInput.h"
+#include "JBEConfig.h"
+
+#include <cstring>
+#include <vector>
+
+//Static vars
+Input::ActionID Input::action_ids_[INPUT_MAX_ACTIONS * 2];
+Uint8 Input::action_slots_[INPUT_MAX_ACTIONS * 2];
+unsigned Input::action_count_ = 0;
+Uint8 Input::action_free_[INPUT_MAX_ACTIONS];
+unsigned Input::action_free_count_ = 0;
+InputBits<INPUT_MAX_ACTIONS> Input::action_unbound_;
+Input::Binding Input::bindings_[INPUT_MAX_BINDINGS];
+unsigned Input::binding_count_ = 0;
+InputBits<INPUT_MAX_BINDINGS> Input::bindings_down_;
+ButtonStates<INPUT_MAX_ACTIONS> Input::actions_;
+
+namespace
+{
+	const unsigned ACTION_TABLE_MASK = INPUT_MAX_ACTIONS * 2 - 1;
+
+	static_assert((INPUT_MAX_ACTIONS & (INPUT_MAX_ACTIONS - 1)) == 0,
+		"INPUT_MAX_ACTIONS must be a power of two");
+	static_assert(INPUT_MAX_ACTIONS <= 256, "action slots are stored in a byte");
+
+	/*
+	*	\brief	One binding as SaveBindings stores it, by ActionID since
+	*			slots depend on the order actions were added in
+	*/
+	struct BindingRecord
+	{
+		Uint32 action;
+		Uint8 type;
+		Uint8 unused;
+		Sint16 which;
+		Uint16 code;
+		Uint16 unused2;
+		float threshold;
+	};
+}
+
+bool Input::BindKey(ActionID action, SDL_Scancode sc)
+{
+	return AddBinding(action, BIND_KEY, sc, 0, 0.0f);
+}
+
+bool Input::BindMouseButton(ActionID action, MOUSE_BTN m)
+{
+	return AddBinding(action, BIND_MOUSE_BUTTON, m, 0, 0.0f);
+}
+
+bool Input::BindGamePadButton(ActionID action, SDL_GameControllerButton btn, int which)
+{
+	return AddBinding(action, BIND_GAMEPAD_BUTTON, btn, which, 0.0f);
+}
+
+bool Input::BindGamePadAxis(ActionID action, SDL_GameControllerAxis axis, float threshold, int which)
+{
+	return AddBinding(action, BIND_GAMEPAD_AXIS, axis, which, threshold);
+}
+
+bool Input::BindGamePadAxisButton(ActionID action, AXIS_BTN btn, int which)
+{
+	return AddBinding(action, BIND_GAMEPAD_AXIS_BUTTON, btn, which, 0.0f);
+}
+
+void Input::UnbindAction(ActionID action)
+{
+	unsigned slot = FindAction(action, false);
+	if (slot == INPUT_MAX_ACTIONS)
+		return;
+
+	//Swap remove, binding order does not matter
+	for (unsigned b = 0; b < binding_count_;)
+	{
+		if (bindings_[b].slot == slot)
+		{
+			bindings_[b] = bindings_[--binding_count_];
+			bindings_down_.Set(b, bindings_down_.Test(binding_count_));
+			bindings_down_.Set(binding_count_, false);
+		}
+		else
+			++b;
+	}
+
+	//Freed by a later Update, once the release has been seen
+	action_unbound_.Set(slot, true);
+}
+
+void Input::ClearActions()
+{
+	for (unsigned i = 0; i <= ACTION_TABLE_MASK; ++i)
+		action_ids_[i] = 0;
+
+	action_count_ = 0;
+	action_free_count_ = 0;
+	action_unbound_.Clear();
+	binding_count_ = 0;
+	bindings_down_.Clear();
+	actions_.Clear();
+
+	//Everything keyed by slot goes too, or it would follow whichever
+	//action is added to the slot next
+	for (unsigned i = 0; i < sub_count_; ++i)
+	{
+		if (subs_[i].id != 0 && (subs_[i].key >> 24) == EVENT_ACTION)
+		{
+			subs_[i].id = 0;
+			++subs_dead_;
+		}
+	}
+
+	for (unsigned p = 0; p < INPUT_MAX_PLAYERS; ++p)
+		players_[p].actions.Clear();
+
+	for (unsigned c = 0; c < INPUT_MAX_CONTEXTS; ++c)
+	{
+		for (unsigned slot = 0; slot < INPUT_MAX_ACTIONS; ++slot)
+			ctx_consumed_[c].actions.Set(slot, ctx_consume_all_[c]);
+
+		ctx_actions_prev_[c].Clear();
+	}
+
+	ComputeContextMasks();
+}
+
+void Input::SaveBindings(ConfigWriter & config, const char * name)
+{
+	ActionID slot_ids[INPUT_MAX_ACTIONS];
+	for (unsigned i = 0; i <= ACTION_TABLE_MASK; ++i)
+		if (action_ids_[i] != 0)
+			slot_ids[action_slots_[i]] = action_ids_[i];
+
+	std::vector<BindingRecord> records(binding_count_);
+	for (unsigned i = 0; i < binding_count_; ++i)
+	{
+		const Binding & b = bindings_[i];
+		BindingRecord & r = records[i];
+
+		std::memset(&r, 0, sizeof(r));
+		r.action = slot_ids[b.slot];
+		r.type = b.type;
+		r.which = b.which;
+		r.code = b.code;
+		r.threshold = b.threshold;
+	}
+
+	config.SetBlob(name, records.data(), records.size() * sizeof(BindingRecord));
+}
+
+bool Input::LoadBindings(const Config & config, const char * name)
+{
+	size_t size;
+	const void * blob = config.GetBlob(JBEHash(name), size);
+	if (blob == nullptr || size % sizeof(BindingRecord) != 0 || size / sizeof(BindingRecord) > INPUT_MAX_BINDINGS)
+		return false;
+
+	//Blobs are not aligned, and a bad code would index past the device state
+	std::vector<BindingRecord> records(size / sizeof(BindingRecord));
+	std::memcpy(records.data(), blob, size);
+
+	for (unsigned i = 0; i < records.size(); ++i)
+	{
+		const BindingRecord & r = records[i];
+		unsigned codes = 0;
+
+		switch (r.type)
+		{
+		case BIND_KEY: codes = SDL_NUM_SCANCODES; break;
+		case BIND_MOUSE_BUTTON: codes = MOUSE_NUMBTNS + 1; break;
+		case BIND_GAMEPAD_BUTTON: codes = SDL_CONTROLLER_BUTTON_MAX; break;
+		case BIND_GAMEPAD_AXIS: codes = SDL_CONTROLLER_AXIS_MAX; break;
+		case BIND_GAMEPAD_AXIS_BUTTON: codes = AXIS_NUMBTNS; break;
+		}
+
+		if (r.action == 0 || r.code >= codes)
+			return false;
+	}
+
+	//Only the bindings are replaced. Actions keep their slots, so the ones
+	//subscribed or consumed before loading still are, and the ones left
+	//unbound are freed by Update as after UnbindAction.
+	for (unsigned i = 0; i <= ACTION_TABLE_MASK; ++i)
+		if (action_ids_[i] != 0)
+			action_unbound_.Set(action_slots_[i], true);
+
+	binding_count_ = 0;
+	bindings_down_.Clear();
+
+	for (unsigned i = 0; i < records.size(); ++i)
+	{
+		const BindingRecord & r = records[i];
+		AddBinding(r.action, static_cast<BINDING_TYPE>(r.type), r.code, r.which, r.threshold);
+	}
+
+	return true;
+}
+
+bool Input::IsActionTriggered(ActionID action)
+{
+	unsigned slot = FindAction(action, false);
+	return slot != INPUT_MAX_ACTIONS && actions_.triggered.Test(slot);
+}
+
+bool Input::IsActionPressed(ActionID action)
+{
+	unsigned slot = FindAction(action, false);
+	return slot != INPUT_MAX_ACTIONS && actions_.pressed.Test(slot);
+}
+
+bool Input::IsActionReleased(ActionID action)
+{
+	unsigned slot = FindAction(action, false);
+	return slot != INPUT_MAX_ACTIONS && actions_.released.Test(slot);
+}
+
+unsigned Input::FindAction(ActionID action, bool add)
+{
+	if (action == 0)
+		return INPUT_MAX_ACTIONS;
+
+	//IDs are already hashes, their low bits are a good enough start
+	for (unsigned i = action & ACTION_TABLE_MASK;; i = (i + 1) & ACTION_TABLE_MASK)
+	{
+		if (action_ids_[i] == action)
+			return action_slots_[i];
+
+		if (action_ids_[i] == 0)
+		{
+			if (!add || (action_free_count_ == 0 && action_count_ == INPUT_MAX_ACTIONS))
+				return INPUT_MAX_ACTIONS;
+
+			const unsigned slot = (action_free_count_ != 0) ? action_free_[--action_free_count_] : action_count_++;
+			action_ids_[i] = action;
+			action_slots_[i] = static_cast<Uint8>(slot);
+			return slot;
+		}
+	}
+}
+
+bool Input::IsActionReferenced(unsigned slot)
+{
+	for (unsigned i = 0; i < sub_count_; ++i)
+		if (subs_[i].id != 0 && subs_[i].key == SubscriptionKey(EVENT_ACTION, -1, slot))
+			return true;
+
+	//Consumed on its own, or let through on its own by a ConsumeAll
+	for (unsigned c = 0; c < INPUT_MAX_CONTEXTS; ++c)
+		if (ctx_consumed_[c].actions.Test(slot) != ctx_consume_all_[c])
+			return true;
+
+	return false;
+}
+
+void Input::FreeAction(unsigned i)
+{
+	const unsigned slot = action_slots_[i];
+
+	//Backward shift deletion, later entries of the cluster move up so
+	//lookups never need tombstones
+	unsigned hole = i;
+	for (unsigned j = (hole + 1) & ACTION_TABLE_MASK; action_ids_[j] != 0; j = (j + 1) & ACTION_TABLE_MASK)
+	{
+		const unsigned home = action_ids_[j] & ACTION_TABLE_MASK;
+
+		//Only move entries whose home is not between the hole and them
+		if (((j - home) & ACTION_TABLE_MASK) >= ((j - hole) & ACTION_TABLE_MASK))
+		{
+			action_ids_[hole] = action_ids_[j];
+			action_slots_[hole] = action_slots_[j];
+			hole = j;
+		}
+	}
+
+	action_ids_[hole] = 0;
+	action_free_[action_free_count_++] = static_cast<Uint8>(slot);
+
+	//Whatever takes the slot next starts from nothing
+	actions_.Reset(slot);
+	for (unsigned p = 0; p < INPUT_MAX_PLAYERS; ++p)
+		players_[p].actions.Reset(slot);
+
+	for (unsigned c = 0; c < INPUT_MAX_CONTEXTS; ++c)
+	{
+		ctx_consumed_[c].actions.Set(slot, ctx_consume_all_[c]);
+		ctx_actions_prev_[c].Set(slot, false);
+	}
+
+	ComputeContextMasks();
+}
+
+void Input::FreeUnboundActions()
+{
+	//Still down, released by this Update
+	InputBits<INPUT_MAX_ACTIONS> ready;
+	for (unsigned w = 0; w < InputBits<INPUT_MAX_ACTIONS>::WORDS; ++w)
+		ready.words[w] = action_unbound_.words[w] & ~actions_.down.words[w];
+
+	if (!ready.Any())
+		return;
+
+	//FreeAction shifts later entries into 'i', so it is looked at again
+	for (unsigned i = 0; i <= ACTION_TABLE_MASK;)
+	{
+		const unsigned slot = action_slots_[i];
+
+		if (action_ids_[i] != 0 && ready.Test(slot))
+		{
+			ready.Set(slot, false);
+			action_unbound_.Set(slot, false);
+
+			if (!IsActionReferenced(slot))
+			{
+				FreeAction(i);
+				continue;
+			}
+		}
+
+		++i;
+	}
+}
+
+bool Input::AddBinding(ActionID action, BINDING_TYPE type, unsigned code, int which, float threshold)
+{
+	if (binding_count_ == INPUT_MAX_BINDINGS || which > 0x7FFF) //Binding::which is 16 bits
+		return false;
+
+	unsigned slot = FindAction(action, true);
+	if (slot == INPUT_MAX_ACTIONS)
+		return false;
+
+	action_unbound_.Set(slot, false);
+
+	Binding & b = bindings_[binding_count_++];
+	b.slot = static_cast<Uint8>(slot);
+	b.type = type;
+	b.which = static_cast<Sint16>(which < 0 ? -1 : which);
+	b.code = static_cast<Uint16>(code);
+	b.threshold = threshold;
+	return true;
+}
+
+void Input::UpdateActions()
+{
+	if (action_unbound_.Any())
+		FreeUnboundActions();
+
+	InputBits<INPUT_MAX_ACTIONS> down;
+	down.Clear();
+
+	const unsigned count = static_cast<unsigned>(gp_.size());
+
+	for (unsigned i = 0; i < binding_count_; ++i)
+	{
+		const bool is_down = IsBindingDown(bindings_[i], 0, count, true);
+
+		bindings_down_.Set(i, is_down);
+		if (is_down)
+			down.Set(bindings_[i].slot, true);
+	}
+
+	SetActions(actions_, down);
+}
+
+bool Input::IsBindingDown(const Binding & b, unsigned first_pad, unsigned last_pad, bool keyboard)
+{
+	switch (b.type)
+	{
+	case BIND_KEY:
+		return keyboard && kb_.down.Test(b.code);
+	case BIND_MOUSE_BUTTON:
+		return keyboard && m_.down.Test(b.code);
+	case BIND_GAMEPAD_BUTTON:
+	case BIND_GAMEPAD_AXIS:
+	case BIND_GAMEPAD_AXIS_BUTTON:
+		break;
+	default:
+		return false;
+	}
+
+	//Bindings for one controller only look at that one
+	if (b.which >= 0)
+	{
+		const unsigned which = static_cast<unsigned>(b.which);
+		if (which < first_pad || which >= last_pad)
+			return false;
+
+		first_pad = which;
+		last_pad = which + 1;
+	}
+
+	for (unsigned c = first_pad; c < last_pad; ++c)
+	{
+		if (b.type == BIND_GAMEPAD_BUTTON)
+		{
+			if (gp_[c].down.Test(b.code))
+				return true;
+
+			continue;
+		}
+
+		if (b.type == BIND_GAMEPAD_AXIS_BUTTON)
+		{
+			if (gp_axis_btns_[c].down.Test(b.code))
+				return true;
+
+			continue;
+		}
+
+		const float v = gp_axes_[b.code][c];
+		if ((b.threshold >= 0.0f) ? (v >= b.threshold) : (v <= b.threshold))
+			return true;
+	}
+
+	return false;
+}
+
+void Input::SetActions(ButtonStates<INPUT_MAX_ACTIONS> & states, const InputBits<INPUT_MAX_ACTIONS> & down)
+{
+	//Only hand the state machine the actions that changed
+	for (unsigned w = 0; w < InputBits<INPUT_MAX_ACTIONS>::WORDS; ++w)
+	{
+		Uint64 changed = down.words[w] ^ states.raw.words[w];
+
+		for (unsigned b = 0; changed != 0; ++b, changed >>= 1)
+			if (changed & 1)
+				states.Set(w * 64 + b, down.Test(w * 64 + b), frame_time_);
+	}
+
+	states.Update();
+}
@@ -0,0 +1,280 @@
+#pragma once
+#define INPUT_DIRTY_CAPACITY 32
+
+#include <SDL_stdinc.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define INPUT_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+/*
+*	\name	InputBits
+*
+*	\brief	Fixed size bitset with one bit per key or button.
+*
+*	\detail	Storage is rounded up to whole 128 bit lanes and 16 byte aligned
+*			so bulk operations can work a full SSE register at a time.
+*			Bits past 'Bits' are always zero. Bulk operations still use
+*			unaligned loads, states kept in a std::vector are only as
+*			aligned as the heap (8 bytes on 32 bit Windows).
+*/
+template <unsigned Bits>
+struct InputBits
+{
+	enum
+	{
+		LANES = (Bits + 127) / 128,
+		WORDS = LANES * 2
+	};
+
+	alignas(16) Uint64 words[WORDS];
+
+	void Clear()
+	{
+		for (unsigned w = 0; w < WORDS; ++w)
+			words[w] = 0;
+	}
+
+	bool Test(unsigned i) const
+	{
+		return ((words[i >> 6] >> (i & 63)) & 1) != 0;
+	}
+
+	void Set(unsigned i, bool on)
+	{
+		const Uint64 bit = Uint64(1) << (i & 63);
+		words[i >> 6] = on ? (words[i >> 6] | bit) : (words[i >> 6] & ~bit);
+	}
+
+	bool Any() const
+	{
+		Uint64 acc = 0;
+		for (unsigned w = 0; w < WORDS; ++w)
+			acc |= words[w];
+		return acc != 0;
+	}
+};
+
+/*
+*	\name	ButtonStates
+*
+*	\brief	Triggered/pressed/released state machine for 'Bits' buttons.
+*
+*	\detail	Events only ever touch 'raw', through Set. Update samples it
+*			into 'down' and derives the per frame states from 'down' and
+*			'prev', so asking for any of them afterwards is a single bit
+*			test:
+*			<li>
+*			triggered = down & ~prev (first frame down)
+*			pressed   = down &  prev (down for more than one frame)
+*			released  = prev & ~down (first frame up)
+*			</li>
+*			Set also keeps the time each button last changed, went down
+*			and up, and the time it went down before that (for double
+*			taps), and
+*			remembers which buttons it touched in a small dirty list,
+*			and buttons that became triggered or released stay in it for
+*			one more frame so they can move on to pressed or idle. Update
+*			only visits the listed buttons, every other one is stable
+*			(prev == down == raw). If more than INPUT_DIRTY_CAPACITY
+*			buttons are touched in a frame, Update falls back to a full
+*			pass using AND/ANDNOT over 128 bit lanes.
+*/
+template <unsigned Bits>
+struct ButtonStates
+{
+	InputBits<Bits> raw;
+	InputBits<Bits> down;
+	InputBits<Bits> prev;
+
+	InputBits<Bits> triggered;
+	InputBits<Bits> pressed;
+	InputBits<Bits> released;
+
+	/*
+	*	\brief	Buttons Update has to visit, 'listed' has their bits set
+	*/
+	Uint16 dirty[INPUT_DIRTY_CAPACITY];
+	unsigned dirty_count;
+	bool dirty_overflow;
+	InputBits<Bits> listed;
+
+	void Clear()
+	{
+		raw.Clear();
+		down.Clear();
+		prev.Clear();
+		triggered.Clear();
+		pressed.Clear();
+		released.Clear();
+
+		listed.Clear();
+		dirty_count = 0;
+		dirty_overflow = false;
+
+		for (unsigned i = 0; i < Bits; ++i)
+			changed_at[i] = down_at[i] = last_down_at[i] = 0;
+	}
+
+	/*
+	*	\brief	SDL_GetPerformanceCounter value of the last change of 'raw'
+	*/
+	Uint64 changed_at[Bits];
+
+	/*
+	*	\brief	Same as changed_at, for the last time the button went down
+	*			and the time before that. 0 for never. While the button is
+	*			up, changed_at is when it went up.
+	*/
+	Uint64 down_at[Bits];
+	Uint64 last_down_at[Bits];
+
+	/*
+	*	\brief	Sets the button 'i' as down or up since 'when' (a
+	*			SDL_GetPerformanceCounter value). Repeating the current
+	*			state changes nothing.
+	*/
+	void Set(unsigned i, bool is_down, Uint64 when)
+	{
+		if (raw.Test(i) == is_down)
+			return;
+
+		raw.Set(i, is_down);
+		changed_at[i] = when;
+
+		if (is_down)
+		{
+			last_down_at[i] = down_at[i];
+			down_at[i] = when;
+		}
+
+		MarkDirty(i);
+	}
+
+	/*
+	*	\brief	Forgets everything about the button 'i', as if it had never
+	*			changed, so it can stand for another input. A pending
+	*			entry in the dirty list drains on its own.
+	*/
+	void Reset(unsigned i)
+	{
+		raw.Set(i, false);
+		down.Set(i, false);
+		prev.Set(i, false);
+		triggered.Set(i, false);
+		pressed.Set(i, false);
+		released.Set(i, false);
+
+		changed_at[i] = down_at[i] = last_down_at[i] = 0;
+	}
+
+	/*
+	*	\brief	Sets every button that is down as up since 'when', e.g. when
+	*			the device is unplugged, so each one is released once.
+	*/
+	void ReleaseAll(Uint64 when)
+	{
+		for (unsigned w = 0; w < InputBits<Bits>::WORDS; ++w)
+		{
+			Uint64 held = raw.words[w];
+
+			for (unsigned b = 0; held != 0; ++b, held >>= 1)
+				if (held & 1)
+					Set(w * 64 + b, false, when);
+		}
+	}
+
+	void Update()
+	{
+		if (dirty_overflow)
+			UpdateAll();
+		else
+			UpdateDirty();
+	}
+
+private:
+	void MarkDirty(unsigned i)
+	{
+		if (listed.Test(i))
+			return;
+
+		if (dirty_count == INPUT_DIRTY_CAPACITY)
+		{
+			dirty_overflow = true;
+			return;
+		}
+
+		listed.Set(i, true);
+		dirty[dirty_count++] = static_cast<Uint16>(i);
+	}
+
+	void UpdateDirty()
+	{
+		unsigned kept = 0;
+
+		for (unsigned n = 0; n < dirty_count; ++n)
+		{
+			const unsigned i = dirty[n];
+			const bool p = down.Test(i);
+			const bool d = raw.Test(i);
+
+			prev.Set(i, p);
+			down.Set(i, d);
+			triggered.Set(i, d && !p);
+			pressed.Set(i, d && p);
+			released.Set(i, p && !d);
+
+			//Changed this frame, it still has to move to pressed or idle
+			if (p != d)
+				dirty[kept++] = static_cast<Uint16>(i);
+			else
+				listed.Set(i, false);
+		}
+
+		dirty_count = kept;
+	}
+
+	void UpdateAll()
+	{
+#ifdef INPUT_USE_SSE2
+		for (unsigned l = 0; l < InputBits<Bits>::LANES; ++l)
+		{
+			const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(down.words) + l);
+			const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(raw.words) + l);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(prev.words) + l, p);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(down.words) + l, d);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(triggered.words) + l, _mm_andnot_si128(p, d));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(pressed.words) + l, _mm_and_si128(d, p));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(released.words) + l, _mm_andnot_si128(d, p));
+		}
+#else
+		for (unsigned w = 0; w < InputBits<Bits>::WORDS; ++w)
+		{
+			const Uint64 p = down.words[w];
+			const Uint64 d = raw.words[w];
+
+			prev.words[w] = p;
+			down.words[w] = d;
+			triggered.words[w] = d & ~p;
+			pressed.words[w] = d & p;
+			released.words[w] = p & ~d;
+		}
+#endif
+
+		//Rebuild the list from whatever changed this frame
+		listed.Clear();
+		dirty_count = 0;
+		dirty_overflow = false;
+
+		for (unsigned w = 0; w < InputBits<Bits>::WORDS; ++w)
+		{
+			Uint64 changed = triggered.words[w] | released.words[w];
+
+			for (unsigned b = 0; changed != 0; ++b, changed >>= 1)
+				if (changed & 1)
+					MarkDirty(w * 64 + b);
+		}
+	}
+};
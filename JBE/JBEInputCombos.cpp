@@ -0,0 +1,266 @@
+#include "JBEInput.h"
+
+//Static vars
+Uint8 Input::combo_symbols_[INPUT_MAX_COMBOS][INPUT_COMBO_MAX_SYMBOLS];
+Uint8 Input::combo_lengths_[INPUT_MAX_COMBOS];
+unsigned Input::combo_windows_[INPUT_MAX_COMBOS];
+unsigned Input::combo_count_ = 0;
+std::vector<Uint16> Input::combo_next_;
+std::vector<InputBits<INPUT_MAX_COMBOS>> Input::combo_ends_;
+std::vector<Input::ComboTracker> Input::gp_combos_;
+
+namespace
+{
+	//Symbols 0 to 8 are directions 1 to 9, buttons follow
+	const unsigned BUTTON_SYMBOLS = 9;
+	const unsigned SYMBOLS = BUTTON_SYMBOLS + SDL_CONTROLLER_BUTTON_MAX;
+
+	const Uint16 NO_STATE = 0xFFFF;
+	const float STICK_THRESHOLD = 0.5f;
+
+	static_assert((INPUT_HISTORY_FRAMES & (INPUT_HISTORY_FRAMES - 1)) == 0,
+		"INPUT_HISTORY_FRAMES must be a power of two");
+	static_assert(INPUT_MAX_COMBOS * INPUT_COMBO_MAX_SYMBOLS < NO_STATE,
+		"automaton states are stored in 16 bits");
+	static_assert(SDL_CONTROLLER_BUTTON_MAX <= 32, "PadFrame::buttons is 32 bits");
+
+	bool IsDPad(unsigned btn)
+	{
+		return btn >= SDL_CONTROLLER_BUTTON_DPAD_UP && btn <= SDL_CONTROLLER_BUTTON_DPAD_RIGHT;
+	}
+
+	/*
+	*	\brief	Swaps left and right of a numpad direction
+	*/
+	Uint8 Mirror(Uint8 direction)
+	{
+		const unsigned column = (direction - 1) % 3;
+		return static_cast<Uint8>(direction - column + (2 - column));
+	}
+}
+
+bool Input::GetGamePadHistory(unsigned which, unsigned frames_ago, PadFrame & frame)
+{
+	if (which >= gp_combos_.size() || frames_ago >= gp_combos_[which].frames)
+		return false;
+
+	//The last Update wrote to frame_count_'s entry
+	const Uint64 index = (frame_count_ - frames_ago) & (INPUT_HISTORY_FRAMES - 1);
+	frame = gp_combos_[which].history[index];
+	return true;
+}
+
+int Input::AddCombo(const ComboStep * steps, unsigned count, unsigned window)
+{
+	if (combo_count_ == INPUT_MAX_COMBOS)
+		return -1;
+
+	Uint8 * symbols = combo_symbols_[combo_count_];
+	unsigned length = 0;
+
+	for (unsigned i = 0; i < count; ++i)
+	{
+		const bool has_direction = steps[i].direction != 0;
+		const bool has_button = steps[i].button >= 0;
+
+		if (steps[i].direction > 9 || steps[i].button >= SDL_CONTROLLER_BUTTON_MAX ||
+			(!has_direction && !has_button) || (has_button && IsDPad(steps[i].button)))
+			return -1;
+
+		if (length + has_direction + has_button > INPUT_COMBO_MAX_SYMBOLS)
+			return -1;
+
+		if (has_direction)
+			symbols[length++] = static_cast<Uint8>(steps[i].direction - 1);
+		if (has_button)
+			symbols[length++] = static_cast<Uint8>(BUTTON_SYMBOLS + steps[i].button);
+	}
+
+	if (length == 0)
+		return -1;
+
+	combo_lengths_[combo_count_] = static_cast<Uint8>(length);
+	combo_windows_[combo_count_] = window;
+	++combo_count_;
+
+	CompileCombos();
+	return combo_count_ - 1;
+}
+
+void Input::ClearCombos()
+{
+	combo_count_ = 0;
+	CompileCombos();
+}
+
+bool Input::IsComboTriggered(unsigned which, unsigned combo)
+{
+	return which < gp_combos_.size() && combo < INPUT_MAX_COMBOS && gp_combos_[which].triggered.Test(combo);
+}
+
+void Input::SetComboMirrored(unsigned which, bool mirrored)
+{
+	if (which < gp_combos_.size())
+		gp_combos_[which].mirrored = mirrored;
+}
+
+void Input::CompileCombos()
+{
+	//Trie of every combo, missing edges are NO_STATE for now
+	combo_next_.assign(SYMBOLS, NO_STATE);
+	combo_ends_.assign(1, InputBits<INPUT_MAX_COMBOS>());
+	combo_ends_[0].Clear();
+
+	for (unsigned c = 0; c < combo_count_; ++c)
+	{
+		unsigned state = 0;
+
+		for (unsigned i = 0; i < combo_lengths_[c]; ++i)
+		{
+			Uint16 & next = combo_next_[state * SYMBOLS + combo_symbols_[c][i]];
+
+			if (next == NO_STATE)
+			{
+				next = static_cast<Uint16>(combo_ends_.size());
+				combo_ends_.push_back(InputBits<INPUT_MAX_COMBOS>());
+				combo_ends_.back().Clear();
+				combo_next_.resize(combo_next_.size() + SYMBOLS, NO_STATE);
+			}
+
+			//resize may have moved the row, so index again
+			state = combo_next_[state * SYMBOLS + combo_symbols_[c][i]];
+		}
+
+		combo_ends_[state].Set(c, true);
+	}
+
+	//Breadth first, fill every missing edge with the edge of the state's
+	//failure link (the longest proper suffix that is also in the trie),
+	//which turns the trie into a complete automaton
+	const unsigned states = static_cast<unsigned>(combo_ends_.size());
+	std::vector<Uint16> fail(states, 0);
+	std::vector<Uint16> queue;
+	queue.reserve(states);
+
+	for (unsigned a = 0; a < SYMBOLS; ++a)
+	{
+		Uint16 & next = combo_next_[a];
+
+		if (next == NO_STATE)
+			next = 0;
+		else
+			queue.push_back(next);
+	}
+
+	for (unsigned head = 0; head < queue.size(); ++head)
+	{
+		const unsigned state = queue[head];
+
+		for (unsigned a = 0; a < SYMBOLS; ++a)
+		{
+			const Uint16 next = combo_next_[state * SYMBOLS + a];
+			const Uint16 fallback = combo_next_[fail[state] * SYMBOLS + a];
+
+			if (next == NO_STATE)
+			{
+				combo_next_[state * SYMBOLS + a] = fallback;
+				continue;
+			}
+
+			fail[next] = fallback;
+			for (unsigned w = 0; w < InputBits<INPUT_MAX_COMBOS>::WORDS; ++w)
+				combo_ends_[next].words[w] |= combo_ends_[fallback].words[w];
+
+			queue.push_back(next);
+		}
+	}
+
+	//State numbers changed, every controller starts over
+	for (unsigned c = 0; c < gp_combos_.size(); ++c)
+	{
+		gp_combos_[c].state = 0;
+		gp_combos_[c].triggered.Clear();
+	}
+}
+
+void Input::UpdateCombos()
+{
+	if (combo_next_.empty())
+		CompileCombos();
+
+	const Uint64 frame_slot = frame_count_ & (INPUT_HISTORY_FRAMES - 1);
+
+	for (unsigned c = 0; c < gp_combos_.size(); ++c)
+	{
+		ComboTracker & t = gp_combos_[c];
+		t.triggered.Clear();
+
+		if (gp_slot_ids_[c] < 0)
+			continue;
+
+		//Direction from the dpad, or the left stick when the dpad is idle
+		int x = gp_[c].down.Test(SDL_CONTROLLER_BUTTON_DPAD_RIGHT) - gp_[c].down.Test(SDL_CONTROLLER_BUTTON_DPAD_LEFT);
+		int y = gp_[c].down.Test(SDL_CONTROLLER_BUTTON_DPAD_UP) - gp_[c].down.Test(SDL_CONTROLLER_BUTTON_DPAD_DOWN);
+
+		if (x == 0 && y == 0)
+		{
+			const float sx = gp_axes_[SDL_CONTROLLER_AXIS_LEFTX][c];
+			const float sy = gp_axes_[SDL_CONTROLLER_AXIS_LEFTY][c];
+
+			x = (sx >= STICK_THRESHOLD) - (sx <= -STICK_THRESHOLD);
+			y = (sy <= -STICK_THRESHOLD) - (sy >= STICK_THRESHOLD);	//SDL's y grows downwards
+		}
+
+		PadFrame & now = t.history[frame_slot];
+		now.direction = static_cast<Uint8>(5 + x + 3 * y);
+		now.buttons = static_cast<Uint32>(gp_[c].down.words[0] & ((Uint64(1) << SDL_CONTROLLER_BUTTON_MAX) - 1));
+		if (t.frames < INPUT_HISTORY_FRAMES)
+			++t.frames;
+
+		//Symbols of this frame: the direction if it changed, then presses
+		Uint8 symbols[1 + SDL_CONTROLLER_BUTTON_MAX];
+		unsigned count = 0;
+
+		const Uint8 direction = t.mirrored ? Mirror(now.direction) : now.direction;
+		if (direction != t.direction)
+		{
+			t.direction = direction;
+			symbols[count++] = static_cast<Uint8>(direction - 1);
+		}
+
+		Uint64 pressed = gp_[c].triggered.words[0];
+		for (unsigned b = 0; pressed != 0; ++b, pressed >>= 1)
+			if ((pressed & 1) && !IsDPad(b))
+				symbols[count++] = static_cast<Uint8>(BUTTON_SYMBOLS + b);
+
+		for (unsigned i = 0; i < count; ++i)
+		{
+			t.state = combo_next_[t.state * SYMBOLS + symbols[i]];
+			t.symbol_frames[t.symbols % INPUT_COMBO_MAX_SYMBOLS] = frame_count_;
+			++t.symbols;
+
+			const InputBits<INPUT_MAX_COMBOS> & ends = combo_ends_[t.state];
+			if (!ends.Any())
+				continue;
+
+			//Only the combos ending here check how long they took
+			for (unsigned w = 0; w < InputBits<INPUT_MAX_COMBOS>::WORDS; ++w)
+			{
+				Uint64 bits = ends.words[w];
+
+				for (unsigned b = 0; bits != 0; ++b, bits >>= 1)
+				{
+					if (!(bits & 1))
+						continue;
+
+					const unsigned combo = w * 64 + b;
+					const Uint64 first = t.symbols - combo_lengths_[combo];
+					const Uint64 started = t.symbol_frames[first % INPUT_COMBO_MAX_SYMBOLS];
+
+					if (frame_count_ - started <= combo_windows_[combo])
+						t.triggered.Set(combo, true);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,306 @@
+#include "JBEInput.h"
+
+//Static vars
+Input::ContextMasks Input::ctx_consumed_[INPUT_MAX_CONTEXTS];
+Input::ContextMasks Input::ctx_visible_[INPUT_MAX_CONTEXTS];
+bool Input::ctx_consume_all_[INPUT_MAX_CONTEXTS];
+InputBits<INPUT_MAX_ACTIONS> Input::ctx_actions_prev_[INPUT_MAX_CONTEXTS];
+Uint8 Input::ctx_stack_[INPUT_MAX_CONTEXTS];
+unsigned Input::ctx_depth_ = 0;
+
+namespace
+{
+	/*
+	*	\brief	Sets 'visible' to every input 'hidden' does not have, bits
+	*			past 'Bits' stay zero
+	*/
+	template <unsigned Bits>
+	void SetVisible(InputBits<Bits> & visible, const InputBits<Bits> & hidden)
+	{
+		for (unsigned w = 0; w < InputBits<Bits>::WORDS; ++w)
+		{
+			const unsigned first = w * 64;
+			const Uint64 valid = (first >= Bits) ? 0 : (Bits - first >= 64) ? ~Uint64(0) : (Uint64(1) << (Bits - first)) - 1;
+
+			visible.words[w] = ~hidden.words[w] & valid;
+		}
+	}
+
+	template <unsigned Bits>
+	void AddBits(InputBits<Bits> & dst, const InputBits<Bits> & src)
+	{
+		for (unsigned w = 0; w < InputBits<Bits>::WORDS; ++w)
+			dst.words[w] |= src.words[w];
+	}
+
+	template <unsigned Bits>
+	void SetAll(InputBits<Bits> & bits, bool on)
+	{
+		InputBits<Bits> none;
+		none.Clear();
+
+		if (on)
+			SetVisible(bits, none);
+		else
+			bits.Clear();
+	}
+}
+
+bool Input::PushContext(unsigned ctx)
+{
+	if (ctx >= INPUT_MAX_CONTEXTS)
+		return false;
+
+	PopContext(ctx);
+	ctx_stack_[ctx_depth_++] = static_cast<Uint8>(ctx);
+
+	//Only what it saw while on the stack can be released for it
+	ctx_actions_prev_[ctx].Clear();
+
+	ComputeContextMasks();
+	return true;
+}
+
+void Input::PopContext(unsigned ctx)
+{
+	for (unsigned i = 0; i < ctx_depth_; ++i)
+	{
+		if (ctx_stack_[i] == ctx)
+		{
+			for (--ctx_depth_; i < ctx_depth_; ++i)
+				ctx_stack_[i] = ctx_stack_[i + 1];
+
+			ComputeContextMasks();
+			return;
+		}
+	}
+}
+
+bool Input::IsContextActive(unsigned ctx)
+{
+	for (unsigned i = 0; i < ctx_depth_; ++i)
+		if (ctx_stack_[i] == ctx)
+			return true;
+
+	return false;
+}
+
+void Input::ConsumeKey(unsigned ctx, SDL_Scancode sc, bool consume)
+{
+	if (ctx >= INPUT_MAX_CONTEXTS)
+		return;
+
+	ctx_consumed_[ctx].keys.Set(sc, consume);
+	ComputeContextMasks();
+}
+
+void Input::ConsumeMouseButton(unsigned ctx, MOUSE_BTN m, bool consume)
+{
+	if (ctx >= INPUT_MAX_CONTEXTS)
+		return;
+
+	ctx_consumed_[ctx].mouse.Set(m, consume);
+	ComputeContextMasks();
+}
+
+void Input::ConsumeGamePadButton(unsigned ctx, SDL_GameControllerButton btn, bool consume)
+{
+	if (ctx >= INPUT_MAX_CONTEXTS)
+		return;
+
+	ctx_consumed_[ctx].buttons.Set(btn, consume);
+	ComputeContextMasks();
+}
+
+void Input::ConsumeGamePadAxis(unsigned ctx, SDL_GameControllerAxis axis, bool consume)
+{
+	if (ctx >= INPUT_MAX_CONTEXTS)
+		return;
+
+	ctx_consumed_[ctx].axes.Set(axis, consume);
+	ComputeContextMasks();
+}
+
+void Input::ConsumeAction(unsigned ctx, ActionID action, bool consume)
+{
+	unsigned slot = FindAction(action, true);
+	if (ctx >= INPUT_MAX_CONTEXTS || slot == INPUT_MAX_ACTIONS)
+		return;
+
+	ctx_consumed_[ctx].actions.Set(slot, consume);
+	ComputeContextMasks();
+}
+
+void Input::ConsumeAll(unsigned ctx, bool consume)
+{
+	if (ctx >= INPUT_MAX_CONTEXTS)
+		return;
+
+	ctx_consume_all_[ctx] = consume;
+
+	ContextMasks & c = ctx_consumed_[ctx];
+	SetAll(c.keys, consume);
+	SetAll(c.mouse, consume);
+	SetAll(c.buttons, consume);
+	SetAll(c.axes, consume);
+	SetAll(c.actions, consume);
+	ComputeContextMasks();
+}
+
+bool Input::IsContextKeyTriggered(unsigned ctx, SDL_Scancode sc)
+{
+	return ctx < INPUT_MAX_CONTEXTS && ctx_visible_[ctx].keys.Test(sc) && kb_.triggered.Test(sc);
+}
+
+bool Input::IsContextKeyPressed(unsigned ctx, SDL_Scancode sc)
+{
+	return ctx < INPUT_MAX_CONTEXTS && ctx_visible_[ctx].keys.Test(sc) && kb_.pressed.Test(sc);
+}
+
+bool Input::IsContextKeyReleased(unsigned ctx, SDL_Scancode sc)
+{
+	return ctx < INPUT_MAX_CONTEXTS && ctx_visible_[ctx].keys.Test(sc) && kb_.released.Test(sc);
+}
+
+bool Input::IsContextMouseButtonTriggered(unsigned ctx, MOUSE_BTN m)
+{
+	return ctx < INPUT_MAX_CONTEXTS && ctx_visible_[ctx].mouse.Test(m) && m_.triggered.Test(m);
+}
+
+bool Input::IsContextMouseButtonPressed(unsigned ctx, MOUSE_BTN m)
+{
+	return ctx < INPUT_MAX_CONTEXTS && ctx_visible_[ctx].mouse.Test(m) && m_.pressed.Test(m);
+}
+
+bool Input::IsContextMouseButtonReleased(unsigned ctx, MOUSE_BTN m)
+{
+	return ctx < INPUT_MAX_CONTEXTS && ctx_visible_[ctx].mouse.Test(m) && m_.released.Test(m);
+}
+
+bool Input::IsContextGamePadTriggered(unsigned ctx, unsigned which, SDL_GameControllerButton btn)
+{
+	return ctx < INPUT_MAX_CONTEXTS && ctx_visible_[ctx].buttons.Test(btn) && IsGamePadTriggered(which, btn);
+}
+
+bool Input::IsContextGamePadPressed(unsigned ctx, unsigned which, SDL_GameControllerButton btn)
+{
+	return ctx < INPUT_MAX_CONTEXTS && ctx_visible_[ctx].buttons.Test(btn) && IsGamePadPressed(which, btn);
+}
+
+bool Input::IsContextGamePadReleased(unsigned ctx, unsigned which, SDL_GameControllerButton btn)
+{
+	return ctx < INPUT_MAX_CONTEXTS && ctx_visible_[ctx].buttons.Test(btn) && IsGamePadReleased(which, btn);
+}
+
+float Input::ContextGamePadAxisValue(unsigned ctx, unsigned which, SDL_GameControllerAxis axis)
+{
+	if (ctx >= INPUT_MAX_CONTEXTS || !ctx_visible_[ctx].axes.Test(axis))
+		return 0.0f;
+
+	return GamePadAxisValue(which, axis);
+}
+
+bool Input::IsContextActionTriggered(unsigned ctx, ActionID action)
+{
+	unsigned slot = FindAction(action, false);
+	return ctx < INPUT_MAX_CONTEXTS && slot != INPUT_MAX_ACTIONS && ctx_visible_[ctx].actions.Test(slot) && actions_.triggered.Test(slot);
+}
+
+bool Input::IsContextActionPressed(unsigned ctx, ActionID action)
+{
+	unsigned slot = FindAction(action, false);
+	return ctx < INPUT_MAX_CONTEXTS && slot != INPUT_MAX_ACTIONS && ctx_visible_[ctx].actions.Test(slot) && actions_.pressed.Test(slot);
+}
+
+bool Input::IsContextActionReleased(unsigned ctx, ActionID action)
+{
+	unsigned slot = FindAction(action, false);
+	return ctx < INPUT_MAX_CONTEXTS && slot != INPUT_MAX_ACTIONS && ctx_visible_[ctx].actions.Test(slot) && actions_.released.Test(slot);
+}
+
+void Input::UpdateContexts()
+{
+	if (ctx_depth_ == 0)
+		return;
+
+	for (unsigned i = 0; i < ctx_depth_; ++i)
+		ctx_actions_prev_[ctx_stack_[i]] = ctx_visible_[ctx_stack_[i]].actions;
+
+	ComputeContextMasks();
+}
+
+void Input::ComputeContextMasks()
+{
+	for (unsigned c = 0; c < INPUT_MAX_CONTEXTS; ++c)
+	{
+		ContextMasks & v = ctx_visible_[c];
+		v.keys.Clear();
+		v.mouse.Clear();
+		v.buttons.Clear();
+		v.axes.Clear();
+		v.actions.Clear();
+	}
+
+	ContextMasks hidden;
+	hidden.keys.Clear();
+	hidden.mouse.Clear();
+	hidden.buttons.Clear();
+	hidden.axes.Clear();
+	hidden.actions.Clear();
+
+	//Top down, each context sees what no context above it consumes
+	for (unsigned i = ctx_depth_; i-- > 0;)
+	{
+		const unsigned c = ctx_stack_[i];
+		ContextMasks & v = ctx_visible_[c];
+
+		SetVisible(v.keys, hidden.keys);
+		SetVisible(v.mouse, hidden.mouse);
+		SetVisible(v.buttons, hidden.buttons);
+		SetVisible(v.axes, hidden.axes);
+
+		//Actions down through a visible binding are visible, the ones
+		//that are up keep what the context saw last frame
+		InputBits<INPUT_MAX_ACTIONS> held;
+		held.Clear();
+
+		for (unsigned b = 0; b < binding_count_; ++b)
+			if (bindings_down_.Test(b) && IsBindingVisible(bindings_[b], v))
+				held.Set(bindings_[b].slot, true);
+
+		InputBits<INPUT_MAX_ACTIONS> allowed;
+		SetVisible(allowed, hidden.actions);
+
+		for (unsigned w = 0; w < InputBits<INPUT_MAX_ACTIONS>::WORDS; ++w)
+		{
+			const Uint64 down = actions_.down.words[w];
+			v.actions.words[w] = allowed.words[w] & ((down & held.words[w]) | (~down & ctx_actions_prev_[c].words[w]));
+		}
+
+		const ContextMasks & consumed = ctx_consumed_[c];
+		AddBits(hidden.keys, consumed.keys);
+		AddBits(hidden.mouse, consumed.mouse);
+		AddBits(hidden.buttons, consumed.buttons);
+		AddBits(hidden.axes, consumed.axes);
+		AddBits(hidden.actions, consumed.actions);
+	}
+}
+
+bool Input::IsBindingVisible(const Binding & b, const ContextMasks & visible)
+{
+	switch (b.type)
+	{
+	case BIND_KEY:
+		return visible.keys.Test(b.code);
+	case BIND_MOUSE_BUTTON:
+		return visible.mouse.Test(b.code);
+	case BIND_GAMEPAD_BUTTON:
+		return visible.buttons.Test(b.code);
+	case BIND_GAMEPAD_AXIS:
+		return visible.axes.Test(b.code);
+	case BIND_GAMEPAD_AXIS_BUTTON:
+		return visible.axes.Test(GetAxisOfButton(b.code));
+	default:
+		return false;
+	}
+}
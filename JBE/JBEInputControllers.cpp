@@ -0,0 +1,317 @@
+#include "JBEInput.h"
+
+#include <algorithm>
+#include <cstring>
+
+//Static vars
+std::vector<ButtonStates<SDL_CONTROLLER_BUTTON_MAX>> Input::gp_;
+std::vector<float> Input::gp_raw_axes_[SDL_CONTROLLER_AXIS_MAX];
+std::vector<float> Input::gp_axes_[SDL_CONTROLLER_AXIS_MAX];
+std::vector<Uint64> Input::gp_axes_time_[SDL_CONTROLLER_AXIS_MAX];
+std::vector<SDL_JoystickID> Input::gp_slot_ids_;
+unsigned Input::gp_count_ = 0;
+std::vector<unsigned> Input::gp_retired_;
+std::vector<SDL_JoystickID> Input::gp_table_ids_;
+std::vector<unsigned> Input::gp_table_slots_;
+std::vector<SDL_GameController *> Input::gp_handles_;
+std::vector<ButtonStates<Input::AXIS_NUMBTNS>> Input::gp_axis_btns_;
+float Input::axis_btn_press_[AXIS_NUMBTNS] = { INPUT_AXIS_PRESS, INPUT_AXIS_PRESS, INPUT_AXIS_PRESS, INPUT_AXIS_PRESS,
+	INPUT_AXIS_PRESS, INPUT_AXIS_PRESS, INPUT_AXIS_PRESS, INPUT_AXIS_PRESS, INPUT_AXIS_PRESS, INPUT_AXIS_PRESS };
+float Input::axis_btn_release_[AXIS_NUMBTNS] = { INPUT_AXIS_RELEASE, INPUT_AXIS_RELEASE, INPUT_AXIS_RELEASE, INPUT_AXIS_RELEASE,
+	INPUT_AXIS_RELEASE, INPUT_AXIS_RELEASE, INPUT_AXIS_RELEASE, INPUT_AXIS_RELEASE, INPUT_AXIS_RELEASE, INPUT_AXIS_RELEASE };
+
+namespace
+{
+	static_assert(INPUT_MAX_CONTROLLERS % 4 == 0,
+		"axes are filtered 4 controllers at a time");
+	static_assert(Input::AXIS_NUMBTNS <= 64, "axis buttons are evaluated in one word");
+
+	//Axis and direction of each virtual button, in AXIS_BTN order
+	const SDL_GameControllerAxis BUTTON_AXES[Input::AXIS_NUMBTNS] =
+	{
+		SDL_CONTROLLER_AXIS_LEFTX, SDL_CONTROLLER_AXIS_LEFTX,
+		SDL_CONTROLLER_AXIS_LEFTY, SDL_CONTROLLER_AXIS_LEFTY,
+		SDL_CONTROLLER_AXIS_RIGHTX, SDL_CONTROLLER_AXIS_RIGHTX,
+		SDL_CONTROLLER_AXIS_RIGHTY, SDL_CONTROLLER_AXIS_RIGHTY,
+		SDL_CONTROLLER_AXIS_TRIGGERLEFT, SDL_CONTROLLER_AXIS_TRIGGERRIGHT
+	};
+
+	const float BUTTON_SIGNS[Input::AXIS_NUMBTNS] =
+	{
+		-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 1.0f
+	};
+
+	SDL_JoystickID HandleID(SDL_GameController * gc)
+	{
+		return SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(gc));
+	}
+}
+
+std::vector<unsigned> Input::GetActiveControllers()
+{
+	std::vector<unsigned> retval;
+
+	for (unsigned i = 0; i < gp_slot_ids_.size(); ++i)
+		if (gp_slot_ids_[i] >= 0)
+			retval.push_back(i);
+
+	return retval;
+}
+
+int Input::GetControllerSlot(SDL_JoystickID id)
+{
+	if (id < 0 || gp_table_ids_.empty())
+		return -1;
+
+	//Instance IDs are handed out in sequence, their low bits spread well
+	const unsigned mask = static_cast<unsigned>(gp_table_ids_.size()) - 1;
+
+	for (unsigned i = id & mask;; i = (i + 1) & mask)
+	{
+		if (gp_table_ids_[i] == id)
+			return static_cast<int>(gp_table_slots_[i]);
+
+		if (gp_table_ids_[i] < 0)
+			return -1;
+	}
+}
+
+SDL_JoystickID Input::GetControllerID(unsigned which)
+{
+	return (which < gp_slot_ids_.size()) ? gp_slot_ids_[which] : -1;
+}
+
+SDL_GameController * Input::GetControllerHandle(SDL_JoystickID id)
+{
+	for (unsigned i = 0; i < gp_handles_.size(); ++i)
+		if (HandleID(gp_handles_[i]) == id)
+			return gp_handles_[i];
+
+	return nullptr;
+}
+
+SDL_JoystickID Input::OpenController(int device)
+{
+	SDL_GameController * gc = SDL_GameControllerOpen(device);
+	if (gc == nullptr)
+		return -1;
+
+	//SDL hands out the same handle again and counts it, keep only one count
+	for (unsigned i = 0; i < gp_handles_.size(); ++i)
+	{
+		if (gp_handles_[i] == gc)
+		{
+			SDL_GameControllerClose(gc);
+			return HandleID(gc);
+		}
+	}
+
+	gp_handles_.push_back(gc);
+	return HandleID(gc);
+}
+
+void Input::CloseController(SDL_JoystickID id)
+{
+	//Linear, but only runs when a device is unplugged
+	for (unsigned i = 0; i < gp_handles_.size(); ++i)
+	{
+		if (HandleID(gp_handles_[i]) == id)
+		{
+			SDL_GameControllerClose(gp_handles_[i]);
+			gp_handles_[i] = gp_handles_.back();
+			gp_handles_.pop_back();
+			return;
+		}
+	}
+}
+
+void Input::AddController(SDL_JoystickID id)
+{
+	if (id < 0 || GetControllerSlot(id) >= 0)
+		return;
+
+	if (gp_count_ + gp_retired_.size() == gp_slot_ids_.size())
+		GrowControllers(static_cast<unsigned>(gp_slot_ids_.size()) * 2);
+
+	unsigned slot = 0;
+	while (gp_slot_ids_[slot] >= 0 || std::find(gp_retired_.begin(), gp_retired_.end(), slot) != gp_retired_.end())
+		++slot;
+
+	gp_slot_ids_[slot] = id;
+	++gp_count_;
+
+	gp_[slot].Clear();
+	gp_axis_btns_[slot].Clear();
+	gp_combos_[slot] = ComboTracker();
+	for (unsigned a = 0; a < SDL_CONTROLLER_AXIS_MAX; ++a)
+	{
+		gp_raw_axes_[a][slot] = gp_axes_[a][slot] = 0.0f;
+		gp_axes_time_[a][slot] = 0;
+	}
+
+	const unsigned mask = static_cast<unsigned>(gp_table_ids_.size()) - 1;
+	unsigned i = id & mask;
+	while (gp_table_ids_[i] >= 0)
+		i = (i + 1) & mask;
+
+	gp_table_ids_[i] = id;
+	gp_table_slots_[i] = slot;
+}
+
+void Input::RemoveController(SDL_JoystickID id, Uint64 when)
+{
+	int slot = GetControllerSlot(id);
+	if (slot < 0)
+		return;
+
+	//Held buttons get released next Update, like any other release
+	gp_[slot].ReleaseAll(when);
+	for (unsigned a = 0; a < SDL_CONTROLLER_AXIS_MAX; ++a)
+	{
+		gp_raw_axes_[a][slot] = 0.0f;
+		gp_axes_time_[a][slot] = when;
+	}
+
+	gp_slot_ids_[slot] = -1;
+	gp_retired_.push_back(slot);
+	--gp_count_;
+
+	//Backward shift deletion, later entries of the cluster move up so
+	//lookups never need tombstones
+	const unsigned mask = static_cast<unsigned>(gp_table_ids_.size()) - 1;
+	unsigned hole = id & mask;
+	while (gp_table_ids_[hole] != id)
+		hole = (hole + 1) & mask;
+
+	for (unsigned i = (hole + 1) & mask; gp_table_ids_[i] >= 0; i = (i + 1) & mask)
+	{
+		unsigned home = gp_table_ids_[i] & mask;
+
+		//Only move entries whose home is not between the hole and them
+		if (((i - home) & mask) >= ((i - hole) & mask))
+		{
+			gp_table_ids_[hole] = gp_table_ids_[i];
+			gp_table_slots_[hole] = gp_table_slots_[i];
+			hole = i;
+		}
+	}
+
+	gp_table_ids_[hole] = -1;
+}
+
+void Input::GrowControllers(unsigned capacity)
+{
+	gp_.resize(capacity);
+	gp_axis_btns_.resize(capacity);
+	gp_combos_.resize(capacity);
+	gp_slot_ids_.resize(capacity, -1);
+
+	for (unsigned a = 0; a < SDL_CONTROLLER_AXIS_MAX; ++a)
+	{
+		gp_raw_axes_[a].resize(capacity, 0.0f);
+		gp_axes_[a].resize(capacity, 0.0f);
+		gp_axes_time_[a].resize(capacity, 0);
+	}
+
+	unsigned table_size = 1;
+	while (table_size < capacity * 2)
+		table_size <<= 1;
+
+	gp_table_ids_.assign(table_size, -1);
+	gp_table_slots_.assign(table_size, 0);
+
+	const unsigned mask = table_size - 1;
+	for (unsigned slot = 0; slot < capacity; ++slot)
+	{
+		SDL_JoystickID id = gp_slot_ids_[slot];
+		if (id < 0)
+			continue;
+
+		unsigned i = id & mask;
+		while (gp_table_ids_[i] >= 0)
+			i = (i + 1) & mask;
+
+		gp_table_ids_[i] = id;
+		gp_table_slots_[i] = slot;
+	}
+}
+
+bool Input::IsGamePadAxisTriggered(unsigned which, AXIS_BTN btn)
+{
+	return which < gp_axis_btns_.size() && gp_axis_btns_[which].triggered.Test(btn);
+}
+
+bool Input::IsGamePadAxisPressed(unsigned which, AXIS_BTN btn)
+{
+	return which < gp_axis_btns_.size() && gp_axis_btns_[which].pressed.Test(btn);
+}
+
+bool Input::IsGamePadAxisReleased(unsigned which, AXIS_BTN btn)
+{
+	return which < gp_axis_btns_.size() && gp_axis_btns_[which].released.Test(btn);
+}
+
+void Input::SetAxisButtonThresholds(AXIS_BTN btn, float press, float release)
+{
+	if (btn >= AXIS_NUMBTNS)
+		return;
+
+	axis_btn_press_[btn] = press;
+	axis_btn_release_[btn] = (release < press) ? release : press;
+}
+
+void Input::UpdateAxisButtons()
+{
+	//Capacity grows from INPUT_MAX_CONTROLLERS by doubling, always whole groups of 4
+	const unsigned count = static_cast<unsigned>(gp_axis_btns_.size());
+
+	for (unsigned c = 0; c < count; c += 4)
+	{
+		//Every button of 4 controllers, one word per controller
+		Uint64 on[4] = { 0, 0, 0, 0 };
+		Uint64 off[4] = { 0, 0, 0, 0 };
+
+		for (unsigned b = 0; b < AXIS_NUMBTNS; ++b)
+		{
+			const float * axis = gp_axes_[BUTTON_AXES[b]].data() + c;
+
+#ifdef INPUT_USE_SSE2
+			const __m128 v = _mm_mul_ps(_mm_loadu_ps(axis), _mm_set1_ps(BUTTON_SIGNS[b]));
+			const int press = _mm_movemask_ps(_mm_cmpge_ps(v, _mm_set1_ps(axis_btn_press_[b])));
+			const int release = _mm_movemask_ps(_mm_cmple_ps(v, _mm_set1_ps(axis_btn_release_[b])));
+
+			for (unsigned l = 0; l < 4; ++l)
+			{
+				on[l] |= static_cast<Uint64>((press >> l) & 1) << b;
+				off[l] |= static_cast<Uint64>((release >> l) & 1) << b;
+			}
+#else
+			for (unsigned l = 0; l < 4; ++l)
+			{
+				const float v = axis[l] * BUTTON_SIGNS[b];
+				on[l] |= static_cast<Uint64>(v >= axis_btn_press_[b]) << b;
+				off[l] |= static_cast<Uint64>(v <= axis_btn_release_[b]) << b;
+			}
+#endif
+		}
+
+		for (unsigned l = 0; l < 4; ++l)
+		{
+			ButtonStates<AXIS_NUMBTNS> & states = gp_axis_btns_[c + l];
+
+			const Uint64 was = states.raw.words[0];
+			Uint64 changed = (on[l] | (was & ~off[l])) ^ was;
+
+			for (unsigned b = 0; changed != 0; ++b, changed >>= 1)
+				if (changed & 1)
+					states.Set(b, ((was >> b) & 1) == 0, gp_axes_time_[BUTTON_AXES[b]][c + l]);
+
+			states.Update();
+		}
+	}
+}
+
+SDL_GameControllerAxis Input::GetAxisOfButton(unsigned btn)
+{
+	return (btn < AXIS_NUMBTNS) ? BUTTON_AXES[btn] : SDL_CONTROLLER_AXIS_INVALID;
+}
@@ -0,0 +1,228 @@
+#include "JBEInput.h"
+
+#include <utility>
+
+//Static vars
+Input::Subscription Input::subs_[INPUT_MAX_SUBSCRIPTIONS];
+unsigned Input::sub_count_ = 0;
+unsigned Input::subs_sorted_ = 0;
+unsigned Input::subs_dead_ = 0;
+Uint32 Input::sub_types_ = 0;
+Input::SubscriptionID Input::next_sub_id_ = 0;
+bool Input::dispatching_ = false;
+
+Input::SubscriptionID Input::SubscribeKey(SDL_Scancode sc, const InputCallback & callback)
+{
+	return Subscribe(EVENT_KEY, -1, sc, sc, callback);
+}
+
+Input::SubscriptionID Input::SubscribeMouseButton(MOUSE_BTN m, const InputCallback & callback)
+{
+	return Subscribe(EVENT_MOUSE_BUTTON, -1, m, m, callback);
+}
+
+Input::SubscriptionID Input::SubscribeGamePadButton(SDL_GameControllerButton btn, const InputCallback & callback, int which)
+{
+	return Subscribe(EVENT_GAMEPAD_BUTTON, which, btn, btn, callback);
+}
+
+Input::SubscriptionID Input::SubscribeAction(ActionID action, const InputCallback & callback)
+{
+	unsigned slot = FindAction(action, true);
+	if (slot == INPUT_MAX_ACTIONS)
+		return 0;
+
+	return Subscribe(EVENT_ACTION, -1, slot, action, callback);
+}
+
+void Input::Unsubscribe(SubscriptionID id)
+{
+	if (id == 0)
+		return;
+
+	//The callback may be the one running, it is destroyed by the next sort
+	for (unsigned i = 0; i < sub_count_; ++i)
+	{
+		if (subs_[i].id == id)
+		{
+			subs_[i].id = 0;
+			++subs_dead_;
+			return;
+		}
+	}
+}
+
+void Input::UnsubscribeAll()
+{
+	for (unsigned i = 0; i < sub_count_; ++i)
+	{
+		if (subs_[i].id != 0)
+		{
+			subs_[i].id = 0;
+			++subs_dead_;
+		}
+	}
+
+	if (!dispatching_)
+		SortSubscriptions();
+}
+
+Uint32 Input::SubscriptionKey(EVENT_TYPE type, int which, unsigned code)
+{
+	return (static_cast<Uint32>(type) << 24) | (static_cast<Uint32>(which + 1) << 16) | code;
+}
+
+Input::SubscriptionID Input::Subscribe(EVENT_TYPE type, int which, unsigned code, Uint32 event_code, const InputCallback & callback)
+{
+	//SubscriptionKey has 8 bits for the controller and 16 for the code
+	if (which < -1 || which > 0xFE || code > 0xFFFF)
+		return 0;
+
+	if (sub_count_ == INPUT_MAX_SUBSCRIPTIONS && subs_dead_ != 0 && !dispatching_)
+		SortSubscriptions();
+
+	if (sub_count_ == INPUT_MAX_SUBSCRIPTIONS)
+		return 0;
+
+	if (++next_sub_id_ == 0)
+		++next_sub_id_;
+
+	Subscription & s = subs_[sub_count_++];
+	s.key = SubscriptionKey(type, which, code);
+	s.id = next_sub_id_;
+	s.code = event_code;
+	s.callback = callback;
+
+	sub_types_ |= 1u << type;
+	return s.id;
+}
+
+void Input::SortSubscriptions()
+{
+	unsigned kept = 0;
+	unsigned sorted = 0;
+
+	for (unsigned i = 0; i < sub_count_; ++i)
+	{
+		if (subs_[i].id == 0)
+			continue;
+
+		if (i < subs_sorted_)
+			++sorted;
+
+		if (kept != i)
+			subs_[kept] = std::move(subs_[i]);
+		++kept;
+	}
+
+	for (unsigned i = kept; i < sub_count_; ++i)
+		subs_[i].callback.Reset();
+
+	//Only the few new ones are out of place, an insertion sort keeps the
+	//order they subscribed in among equal keys
+	for (unsigned i = sorted; i < kept; ++i)
+	{
+		Subscription s = std::move(subs_[i]);
+		unsigned j = i;
+
+		for (; j > 0 && subs_[j - 1].key > s.key; --j)
+			subs_[j] = std::move(subs_[j - 1]);
+
+		subs_[j] = std::move(s);
+	}
+
+	sub_count_ = subs_sorted_ = kept;
+	subs_dead_ = 0;
+
+	sub_types_ = 0;
+	for (unsigned i = 0; i < sub_count_; ++i)
+		sub_types_ |= 1u << (subs_[i].key >> 24);
+}
+
+template <unsigned Bits>
+void Input::DispatchChanges(const ButtonStates<Bits> & states, EVENT_TYPE type, int which)
+{
+	//After Update the dirty list holds exactly what changed this frame
+	if (!states.dirty_overflow)
+	{
+		for (unsigned n = 0; n < states.dirty_count; ++n)
+		{
+			const unsigned i = states.dirty[n];
+
+			if (states.triggered.Test(i) || states.released.Test(i))
+				Notify(type, which, i, states.down.Test(i));
+		}
+
+		return;
+	}
+
+	for (unsigned w = 0; w < InputBits<Bits>::WORDS; ++w)
+	{
+		Uint64 changed = states.triggered.words[w] | states.released.words[w];
+
+		for (unsigned b = 0; changed != 0; ++b, changed >>= 1)
+			if (changed & 1)
+				Notify(type, which, w * 64 + b, states.down.Test(w * 64 + b));
+	}
+}
+
+void Input::DispatchEvents()
+{
+	if (sub_count_ == 0)
+		return;
+
+	if (subs_dead_ != 0 || subs_sorted_ != sub_count_)
+		SortSubscriptions();
+
+	dispatching_ = true;
+
+	if (sub_types_ & (1u << EVENT_KEY))
+		DispatchChanges(kb_, EVENT_KEY, -1);
+
+	if (sub_types_ & (1u << EVENT_MOUSE_BUTTON))
+		DispatchChanges(m_, EVENT_MOUSE_BUTTON, -1);
+
+	//Unplugged slots still dispatch the releases of their last frame
+	if (sub_types_ & (1u << EVENT_GAMEPAD_BUTTON))
+		for (unsigned c = 0; c < gp_.size(); ++c)
+			DispatchChanges(gp_[c], EVENT_GAMEPAD_BUTTON, static_cast<int>(c));
+
+	if (sub_types_ & (1u << EVENT_ACTION))
+		DispatchChanges(actions_, EVENT_ACTION, -1);
+
+	dispatching_ = false;
+}
+
+void Input::Notify(EVENT_TYPE type, int which, unsigned code, bool down)
+{
+	InputEvent ev;
+	ev.type = type;
+	ev.down = down;
+	ev.which = which;
+
+	//Subscribers of this controller, then those of any controller
+	for (int pass = (which < 0) ? 1 : 0; pass < 2; ++pass)
+	{
+		const Uint32 key = SubscriptionKey(type, pass ? -1 : which, code);
+
+		unsigned lo = 0, hi = subs_sorted_;
+		while (lo < hi)
+		{
+			const unsigned mid = (lo + hi) / 2;
+			if (subs_[mid].key < key)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+		//Indexes only, callbacks append to the table while this runs
+		for (unsigned i = lo; i < subs_sorted_ && subs_[i].key == key; ++i)
+		{
+			if (subs_[i].id == 0)
+				continue;
+
+			ev.code = subs_[i].code;
+			subs_[i].callback(ev);
+		}
+	}
+}
@@ -0,0 +1,192 @@
+#include "JBEInputHistory.h"
+
+#include <cstring>
+
+namespace
+{
+	static_assert((INPUT_ROLLBACK_FRAMES & (INPUT_ROLLBACK_FRAMES - 1)) == 0,
+		"INPUT_ROLLBACK_FRAMES must be a power of two");
+	static_assert(INPUT_MAX_ACTIONS <= 64, "PlayerInput::actions is 64 bits");
+	static_assert(SDL_CONTROLLER_BUTTON_MAX <= 32, "PlayerInput::buttons is 32 bits");
+
+	const Input::PlayerInput NO_INPUT = { 0, { 0 }, 0 };
+
+	bool Same(const Input::PlayerInput & a, const Input::PlayerInput & b)
+	{
+		return std::memcmp(&a, &b, sizeof(Input::PlayerInput)) == 0;
+	}
+}
+
+void Input::CapturePlayerInput(int which, PlayerInput & input)
+{
+	//Cleared as a whole, InputHistory compares these with memcmp
+	std::memset(&input, 0, sizeof(input));
+	input.actions = actions_.down.words[0];
+
+	if (which < 0 || static_cast<unsigned>(which) >= gp_.size() || gp_slot_ids_[which] < 0)
+		return;
+
+	input.buttons = static_cast<Uint32>(gp_[which].down.words[0] & ((Uint64(1) << SDL_CONTROLLER_BUTTON_MAX) - 1));
+
+	for (unsigned a = 0; a < SDL_CONTROLLER_AXIS_MAX; ++a)
+	{
+		const float v = gp_axes_[a][which] * 32767.0f;
+		input.axes[a] = static_cast<Sint16>((v < 0.0f) ? v - 0.5f : v + 0.5f);
+	}
+}
+
+bool Input::IsActionDown(const PlayerInput & input, ActionID action)
+{
+	const unsigned slot = FindAction(action, false);
+	return slot < INPUT_MAX_ACTIONS && ((input.actions >> slot) & 1) != 0;
+}
+
+InputHistory::InputHistory(unsigned players, Uint64 first_frame)
+	: players_(players), entries_(INPUT_ROLLBACK_FRAMES * players)
+{
+	Clear(first_frame);
+}
+
+unsigned InputHistory::GetPlayerCount() const
+{
+	return players_;
+}
+
+bool InputHistory::SetInput(unsigned player, Uint64 frame, const Input::PlayerInput & input)
+{
+	if (player >= players_ || frame < first_ || !InWindow(frame))
+		return false;
+
+	if (frame > newest_)
+		newest_ = frame;
+
+	Entry & e = At(player, frame);
+
+	//Already used for this frame, and wrong
+	if (e.frame == frame && e.state != ENTRY_EMPTY && !Same(e.input, input))
+	{
+		if (!has_rollback_ || frame < rollback_)
+			rollback_ = frame;
+		has_rollback_ = true;
+	}
+
+	e.input = input;
+	e.frame = frame;
+	e.state = ENTRY_CONFIRMED;
+
+	if (frame + 1 > last_[player])
+		last_[player] = frame + 1;
+
+	while (IsConfirmed(player, next_[player]))
+		++next_[player];
+
+	return true;
+}
+
+const Input::PlayerInput & InputHistory::GetInput(unsigned player, Uint64 frame)
+{
+	if (player >= players_ || frame < first_ || !InWindow(frame))
+		return NO_INPUT;
+
+	if (frame > newest_)
+		newest_ = frame;
+
+	Entry & e = At(player, frame);
+	if (e.frame == frame && e.state == ENTRY_CONFIRMED)
+		return e.input;
+
+	//Predict the last input confirmed before 'frame' goes on
+	const Input::PlayerInput * predicted = &NO_INPUT;
+	const Uint64 last = last_[player];
+
+	if (last != 0 && last - 1 < frame && InWindow(last - 1))
+		predicted = &At(player, last - 1).input;
+	else
+	{
+		//Inputs arrived out of order, look back for the closest one
+		for (Uint64 f = frame; f > first_ && InWindow(f - 1); --f)
+		{
+			if (IsConfirmed(player, f - 1))
+			{
+				predicted = &At(player, f - 1).input;
+				break;
+			}
+		}
+	}
+
+	e.input = *predicted;
+	e.frame = frame;
+	e.state = ENTRY_PREDICTED;
+	return e.input;
+}
+
+bool InputHistory::IsConfirmed(unsigned player, Uint64 frame) const
+{
+	if (player >= players_)
+		return false;
+
+	//Before the first frame there is nothing left to confirm
+	if (frame < first_)
+		return true;
+
+	if (!InWindow(frame))
+		return false;
+
+	const Entry & e = At(player, frame);
+	return e.frame == frame && e.state == ENTRY_CONFIRMED;
+}
+
+Uint64 InputHistory::GetConfirmedFrame() const
+{
+	Uint64 frame = newest_ + 1;
+
+	for (unsigned p = 0; p < players_; ++p)
+		if (next_[p] < frame)
+			frame = next_[p];
+
+	return frame;
+}
+
+bool InputHistory::GetRollbackFrame(Uint64 & frame) const
+{
+	if (has_rollback_)
+		frame = rollback_;
+
+	return has_rollback_;
+}
+
+void InputHistory::ClearRollback()
+{
+	has_rollback_ = false;
+}
+
+void InputHistory::Clear(Uint64 first_frame)
+{
+	for (unsigned i = 0; i < entries_.size(); ++i)
+	{
+		entries_[i].frame = 0;
+		entries_[i].state = ENTRY_EMPTY;
+	}
+
+	last_.assign(players_, 0);
+	next_.assign(players_, first_frame);
+	first_ = first_frame;
+	newest_ = first_frame;
+	has_rollback_ = false;
+	rollback_ = 0;
+}
+
+InputHistory::Entry & InputHistory::At(unsigned player, Uint64 frame)
+{
+	return entries_[(frame & (INPUT_ROLLBACK_FRAMES - 1)) * players_ + player];
+}
+
+const InputHistory::Entry & InputHistory::At(unsigned player, Uint64 frame) const
+{
+	return entries_[(frame & (INPUT_ROLLBACK_FRAMES - 1)) * players_ + player];
+}
+
+bool InputHistory::InWindow(Uint64 frame) const
+{
+	return frame + INPUT_ROLLBACK_FRAMES > newest_;
+}
@@ -0,0 +1,147 @@
+#pragma once
+#define INPUT_ROLLBACK_FRAMES 64
+
+#include "JBEInput.h"
+
+#include <SDL.h>
+#include <vector>
+
+/*
+*	\name	InputHistory
+*
+*	\brief	Per frame inputs of every player for rollback simulation.
+*
+*	\detail	Frames are numbered like Input::GetFrameCount. Local players
+*			store their input for the frame being simulated with SetInput,
+*			remote (or simulated) players whenever theirs arrive, which
+*			may be several frames late. The simulation reads every player
+*			through GetInput, which hands out a prediction (the last input
+*			confirmed before that frame) for inputs that have not arrived
+*			yet and remembers it. When the real input arrives and differs
+*			from what was predicted, GetRollbackFrame reports the earliest
+*			frame that has to be simulated again.
+*			The last INPUT_ROLLBACK_FRAMES frames are kept in a ring of
+*			PlayerInput allocated once, so storing, predicting and
+*			comparing a frame is a copy and a memcmp of a few bytes per
+*			player. A loopback stand-in peer is just a second player fed
+*			with the local input a few frames late:
+*			<li>
+*			Input::CapturePlayerInput(0, local);
+*			history.SetInput(0, frame, local);
+*			history.SetInput(1, frame - delay, delayed[(frame - delay) % N]);
+*			</li>
+*/
+class InputHistory
+{
+public:
+	/*
+	*	\brief	Allocates the ring for 'players' players. Frames before
+	*			'first_frame' count as confirmed, with no input, for every
+	*			player.
+	*/
+	explicit InputHistory(unsigned players, Uint64 first_frame = 0);
+
+	/*
+	*	\brief	Returns how many players the history holds
+	*/
+	unsigned GetPlayerCount() const;
+
+	/*
+	*	\name	SetInput
+	*
+	*	\brief	Stores the actual input of 'player' for 'frame'.
+	*
+	*	\detail	If 'frame' was already simulated with another input for
+	*			'player', it becomes a rollback frame (see GetRollbackFrame).
+	*
+	*	\retval	true	The input was stored.
+	*	\retval false	'frame' is INPUT_ROLLBACK_FRAMES or more behind the
+	*					newest frame stored, or before the first frame, it
+	*					can no longer be rolled back to.
+	*/
+	bool SetInput(unsigned player, Uint64 frame, const Input::PlayerInput &input);
+
+	/*
+	*	\brief	Returns the input of 'player' to simulate 'frame' with, the
+	*			actual one if it was stored, a prediction otherwise. Frames
+	*			too old to roll back to read as no input.
+	*/
+	const Input::PlayerInput & GetInput(unsigned player, Uint64 frame);
+
+	/*
+	*	\brief	Returns whether the actual input of 'player' for 'frame' was
+	*			stored
+	*/
+	bool IsConfirmed(unsigned player, Uint64 frame) const;
+
+	/*
+	*	\brief	Returns the first frame some player has no actual input for
+	*			yet. Every frame before it is final and never rolls back.
+	*			Stop simulating ahead before it falls INPUT_ROLLBACK_FRAMES
+	*			behind, inputs that old can no longer be stored.
+	*/
+	Uint64 GetConfirmedFrame() const;
+
+	/*
+	*	\brief	Gets the earliest frame simulated with a wrong prediction
+	*			since the last ClearRollback
+	*
+	*	\retval	true	'frame' was set, simulate again from there.
+	*	\retval false	Every prediction used so far was right.
+	*/
+	bool GetRollbackFrame(Uint64 &frame) const;
+
+	/*
+	*	\brief	Forgets the rollback frame, once the simulation has gone
+	*			back to it
+	*/
+	void ClearRollback();
+
+	/*
+	*	\brief	Forgets every stored input, see the constructor
+	*/
+	void Clear(Uint64 first_frame = 0);
+
+private:
+	enum ENTRY_STATE : Uint8
+	{
+		ENTRY_EMPTY,
+		ENTRY_PREDICTED,
+		ENTRY_CONFIRMED
+	};
+
+	struct Entry
+	{
+		Input::PlayerInput input;
+		Uint64 frame;
+		Uint8 state;	//ENTRY_STATE
+	};
+
+	Entry & At(unsigned player, Uint64 frame);
+	const Entry & At(unsigned player, Uint64 frame) const;
+
+	/*
+	*	\brief	Whether 'frame' is still in the ring
+	*/
+	bool InWindow(Uint64 frame) const;
+
+	unsigned players_;
+
+	/*
+	*	\brief	INPUT_ROLLBACK_FRAMES rows of one entry per player, row
+	*			'frame % INPUT_ROLLBACK_FRAMES' for each frame
+	*/
+	std::vector<Entry> entries_;
+
+	/*
+	*	\brief	Per player, one past the newest frame confirmed (0 for
+	*			none) and the first frame not confirmed
+	*/
+	std::vector<Uint64> last_;
+	std::vector<Uint64> next_;
+
+	Uint64 first_;
+	Uint64 newest_;
+	Uint64 rollback_;
+	bool has_rollback_;
+};
@@ -0,0 +1,274 @@
+#include "JBEInputLog.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	const char LOG_MAGIC[4] = { 'J', 'B', 'E', 'I' };
+}
+
+InputRecorder::InputRecorder() : file_(nullptr), failed_(false), frames_(0), count_(0)
+{
+}
+
+InputRecorder::~InputRecorder()
+{
+	Close();
+}
+
+bool InputRecorder::Open(const char * path)
+{
+	Close();
+
+	file_ = SDL_RWFromFile(path, "wb");
+	if (file_ == nullptr)
+		return false;
+
+	InputLogHeader header;
+	std::memcpy(header.magic, LOG_MAGIC, sizeof(header.magic));
+	header.version = INPUT_LOG_VERSION;
+	header.record_size = sizeof(Input::Record);
+	header.reserved = 0;
+	header.frequency = SDL_GetPerformanceFrequency();
+
+	if (SDL_RWwrite(file_, &header, sizeof(header), 1) != 1)
+	{
+		SDL_RWclose(file_);
+		file_ = nullptr;
+		return false;
+	}
+
+	failed_ = false;
+	frames_ = 0;
+	count_ = 0;
+	return true;
+}
+
+bool InputRecorder::Close()
+{
+	if (file_ == nullptr)
+		return !failed_;
+
+	Flush();
+	if (SDL_RWclose(file_) != 0)
+		failed_ = true;
+
+	file_ = nullptr;
+	return !failed_;
+}
+
+void InputRecorder::Write(const Input::Record & rec)
+{
+	if (file_ == nullptr || failed_)
+		return;
+
+	buffer_[count_++] = rec;
+
+	if (count_ == INPUT_LOG_BUFFER)
+		Flush();
+}
+
+void InputRecorder::WriteFrame(Uint64 frame_time)
+{
+	Input::Record marker;
+	marker.counter = frame_time;
+	marker.timestamp = SDL_GetTicks();
+	marker.type = INPUT_LOG_FRAME;
+	marker.code = 0;
+	marker.which = static_cast<Sint32>(frames_++);
+	marker.value = 0;
+
+	Write(marker);
+}
+
+unsigned InputRecorder::GetFrameCount() const
+{
+	return frames_;
+}
+
+bool InputRecorder::HasFailed() const
+{
+	return failed_;
+}
+
+void InputRecorder::Flush()
+{
+	if (count_ != 0 && SDL_RWwrite(file_, buffer_, sizeof(Input::Record), count_) != count_)
+		failed_ = true;
+
+	count_ = 0;
+}
+
+InputReplay::InputReplay() : records_(nullptr), count_(0), cursor_(0), frame_(0),
+	first_counter_(0), base_(0), scale_(1.0),
+	view_(nullptr), view_size_(0),
+#ifdef _WIN32
+	file_(INVALID_HANDLE_VALUE), mapping_(nullptr)
+#else
+	file_(-1)
+#endif
+{
+}
+
+InputReplay::~InputReplay()
+{
+	Close();
+}
+
+bool InputReplay::Open(const char * path)
+{
+	Close();
+
+#ifdef _WIN32
+	file_ = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file_ == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file_, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(InputLogHeader)))
+	{
+		Close();
+		return false;
+	}
+
+	mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping_ == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	view_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+	view_size_ = static_cast<size_t>(size.QuadPart);
+#else
+	file_ = open(path, O_RDONLY);
+	if (file_ < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(file_, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(InputLogHeader)))
+	{
+		Close();
+		return false;
+	}
+
+	void * view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, file_, 0);
+	if (view != MAP_FAILED)
+	{
+		madvise(view, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+		view_ = view;
+		view_size_ = static_cast<size_t>(st.st_size);
+	}
+#endif
+
+	if (view_ == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	const InputLogHeader * header = static_cast<const InputLogHeader *>(view_);
+	if (std::memcmp(header->magic, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0 ||
+		header->version != INPUT_LOG_VERSION ||
+		header->record_size != sizeof(Input::Record))
+	{
+		Close();
+		return false;
+	}
+
+	records_ = reinterpret_cast<const Input::Record *>(header + 1);
+	count_ = (view_size_ - sizeof(InputLogHeader)) / sizeof(Input::Record);
+	first_counter_ = (count_ != 0) ? records_[0].counter : 0;
+	scale_ = (header->frequency != 0) ?
+		static_cast<double>(SDL_GetPerformanceFrequency()) / static_cast<double>(header->frequency) : 1.0;
+	Rewind();
+	return true;
+}
+
+void InputReplay::Close()
+{
+#ifdef _WIN32
+	if (view_)
+		UnmapViewOfFile(view_);
+	if (mapping_)
+		CloseHandle(mapping_);
+	if (file_ != INVALID_HANDLE_VALUE)
+		CloseHandle(file_);
+
+	mapping_ = nullptr;
+	file_ = INVALID_HANDLE_VALUE;
+#else
+	if (view_)
+		munmap(const_cast<void *>(view_), view_size_);
+	if (file_ >= 0)
+		close(file_);
+
+	file_ = -1;
+#endif
+
+	view_ = nullptr;
+	view_size_ = 0;
+	records_ = nullptr;
+	count_ = 0;
+	Rewind();
+}
+
+bool InputReplay::NextFrame()
+{
+	while (cursor_ < count_)
+	{
+		const Input::Record & rec = records_[cursor_++];
+
+		if (rec.type == INPUT_LOG_FRAME)
+		{
+			Input::InjectFrameTime(ToLocal(rec.counter));
+			++frame_;
+			return true;
+		}
+
+		Input::Record local = rec;
+		local.counter = ToLocal(rec.counter);
+		Input::InjectRecord(local, true);
+	}
+
+	return false;
+}
+
+void InputReplay::Rewind()
+{
+	cursor_ = 0;
+	frame_ = 0;
+
+	//Replayed times start now, so they never run backwards from the
+	//frames Input has seen before
+	base_ = SDL_GetPerformanceCounter();
+}
+
+unsigned InputReplay::GetFrame() const
+{
+	return frame_;
+}
+
+Uint64 InputReplay::ToLocal(Uint64 counter) const
+{
+	//Signed, records are stamped back from when SDL queued them and may
+	//come slightly before the first one
+	const Sint64 since = static_cast<Sint64>(counter - first_counter_);
+
+	if (scale_ == 1.0)
+		return base_ + static_cast<Uint64>(since);
+
+	return base_ + static_cast<Uint64>(static_cast<Sint64>(static_cast<double>(since) * scale_));
+}
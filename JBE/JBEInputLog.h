@@ -0,0 +1,179 @@
+#pragma once
+#define INPUT_LOG_BUFFER 1024
+#define INPUT_LOG_VERSION 4
+
+#include "JBEInput.h"
+
+#include <SDL.h>
+#include <cstddef>
+
+/*
+*	\brief	Header at the start of every input log. Records follow it
+*			back to back, in the byte order of the machine that wrote them.
+*/
+struct InputLogHeader
+{
+	char magic[4];			//'J','B','E','I'
+	Uint32 version;			//INPUT_LOG_VERSION
+	Uint32 record_size;		//sizeof(Input::Record)
+	Uint32 reserved;
+	Uint64 frequency;		//SDL_GetPerformanceFrequency of the recording machine
+};
+
+/*
+*	\brief	Record type used as the frame marker, SDL never sends it. The
+*			marker's 'which' holds the frame number and its 'counter'
+*			the frame time of that Update.
+*/
+const Uint16 INPUT_LOG_FRAME = SDL_FIRSTEVENT;
+
+/*
+*	\name	InputRecorder
+*
+*	\brief	Writes the records applied by Input, and a marker per frame,
+*			to a binary log file. See Input::SetRecorder.
+*
+*	\detail	Records are copied into a fixed buffer of INPUT_LOG_BUFFER
+*			entries which is only written out when full or on Close, so
+*			logging never allocates.
+*/
+class InputRecorder
+{
+public:
+	InputRecorder();
+	~InputRecorder();
+
+	InputRecorder(const InputRecorder &) = delete;
+	InputRecorder & operator=(const InputRecorder &) = delete;
+
+	/*
+	*	\brief	Creates (or truncates) the log at 'path' and writes its header
+	*
+	*	\retval	true	The file is ready to be written.
+	*	\retval	false	The file could not be opened, see SDL_GetError.
+	*/
+	bool Open(const char *path);
+
+	/*
+	*	\brief	Writes whatever is still buffered and closes the file
+	*
+	*	\retval	true	The whole log was written.
+	*	\retval	false	Writing failed at some point, see HasFailed.
+	*/
+	bool Close();
+
+	/*
+	*	\brief	Appends one record to the log
+	*/
+	void Write(const Input::Record &rec);
+
+	/*
+	*	\brief	Appends the marker of a frame run at 'frame_time' to the log
+	*/
+	void WriteFrame(Uint64 frame_time);
+
+	/*
+	*	\brief	Returns the amount of frames logged since Open
+	*/
+	unsigned GetFrameCount() const;
+
+	/*
+	*	\brief	Returns whether writing to the file failed (e.g. the disk is
+	*			full) since Open. Nothing is logged after a failure, so
+	*			the log ends at the last frame written before it.
+	*/
+	bool HasFailed() const;
+
+private:
+	void Flush();
+
+	SDL_RWops *file_;
+	bool failed_;
+	unsigned frames_;
+	unsigned count_;
+	Input::Record buffer_[INPUT_LOG_BUFFER];
+};
+
+/*
+*	\name	InputReplay
+*
+*	\brief	Plays back a log written by InputRecorder, frame by frame,
+*			through Input::InjectRecord.
+*
+*	\detail	The file is memory mapped rather than read, so only the pages
+*			being replayed have to be resident and a long log starts
+*			playing immediately. Recorded times are moved to this run's
+*			clock, keeping their distances, so hold, double tap and age
+*			queries give the recorded results whatever the replay speed.
+*			A frame is replayed with
+*			<li>
+*			while (replay.NextFrame())
+*				Input::Update();
+*			</li>
+*			which mirrors WindowManager::Update followed by Input::Update.
+*/
+class InputReplay
+{
+public:
+	InputReplay();
+	~InputReplay();
+
+	InputReplay(const InputReplay &) = delete;
+	InputReplay & operator=(const InputReplay &) = delete;
+
+	/*
+	*	\brief	Maps the log at 'path' and validates its header
+	*
+	*	\retval	true	The log is ready to be played.
+	*	\retval	false	The file is missing, unreadable or not a log this
+	*					build can play.
+	*/
+	bool Open(const char *path);
+
+	/*
+	*	\brief	Unmaps the log
+	*/
+	void Close();
+
+	/*
+	*	\brief	Injects every record up to the next frame marker
+	*
+	*	\retval	true	A frame was replayed, Input::Update should run now.
+	*	\retval	false	The log has ended.
+	*/
+	bool NextFrame();
+
+	/*
+	*	\brief	Rewinds to the first frame of the log
+	*/
+	void Rewind();
+
+	/*
+	*	\brief	Returns the amount of frames replayed since Open or Rewind
+	*/
+	unsigned GetFrame() const;
+
+private:
+	/*
+	*	\brief	Moves a recorded counter to this run's clock
+	*/
+	Uint64 ToLocal(Uint64 counter) const;
+
+	const Input::Record *records_;
+	size_t count_;
+	size_t cursor_;
+	unsigned frame_;
+
+	Uint64 first_counter_;	//counter of the first record
+	Uint64 base_;			//where first_counter_ is moved to
+	double scale_;			//this machine's counter frequency over the recorded one
+
+	const void *view_;
+	size_t view_size_;
+#ifdef _WIN32
+	void *file_;
+	void *mapping_;
+#else
+	int file_;
+#endif
+};
@@ -0,0 +1,220 @@
+#include "JBEInput.h"
+
+//Static vars
+Input::Player Input::players_[INPUT_MAX_PLAYERS];
+bool Input::join_on_press_ = false;
+Uint32 Input::players_joined_ = 0;
+
+namespace
+{
+	static_assert(INPUT_MAX_PLAYERS <= 32, "players_joined_ is 32 bits");
+}
+
+bool Input::AssignController(unsigned player, unsigned which)
+{
+	if (player >= INPUT_MAX_PLAYERS || which >= gp_slot_ids_.size() || gp_slot_ids_[which] < 0)
+		return false;
+
+	const int slot = static_cast<int>(which);
+
+	for (unsigned p = 0; p < INPUT_MAX_PLAYERS; ++p)
+	{
+		if (players_[p].pad_id == gp_slot_ids_[which])
+		{
+			players_[p].pad_id = -1;
+			players_[p].pad = -1;
+		}
+	}
+
+	JoinPlayer(player);
+	players_[player].pad_id = gp_slot_ids_[which];
+	players_[player].pad = slot;
+	return true;
+}
+
+bool Input::AssignKeyboard(unsigned player)
+{
+	if (player >= INPUT_MAX_PLAYERS)
+		return false;
+
+	for (unsigned p = 0; p < INPUT_MAX_PLAYERS; ++p)
+		players_[p].keyboard = false;
+
+	JoinPlayer(player);
+	players_[player].keyboard = true;
+	return true;
+}
+
+void Input::RemovePlayer(unsigned player)
+{
+	if (player >= INPUT_MAX_PLAYERS)
+		return;
+
+	Player & pl = players_[player];
+	pl.joined = false;
+	pl.keyboard = false;
+	pl.pad_id = -1;
+	pl.pad = -1;
+	pl.actions.Clear();
+	players_joined_ &= ~(Uint32(1) << player);
+}
+
+void Input::SetJoinOnPress(bool enabled)
+{
+	join_on_press_ = enabled;
+}
+
+bool Input::IsPlayerJoined(unsigned player)
+{
+	return player < INPUT_MAX_PLAYERS && players_[player].joined;
+}
+
+bool Input::HasPlayerJoined(unsigned player)
+{
+	return player < INPUT_MAX_PLAYERS && ((players_joined_ >> player) & 1) != 0;
+}
+
+int Input::GetPlayerController(unsigned player)
+{
+	return (player < INPUT_MAX_PLAYERS) ? players_[player].pad : -1;
+}
+
+bool Input::HasPlayerKeyboard(unsigned player)
+{
+	return player < INPUT_MAX_PLAYERS && players_[player].keyboard;
+}
+
+int Input::GetControllerPlayer(unsigned which)
+{
+	for (unsigned p = 0; p < INPUT_MAX_PLAYERS; ++p)
+		if (players_[p].pad >= 0 && static_cast<unsigned>(players_[p].pad) == which)
+			return static_cast<int>(p);
+
+	return -1;
+}
+
+bool Input::IsPlayerActionTriggered(unsigned player, ActionID action)
+{
+	unsigned slot = FindAction(action, false);
+	return player < INPUT_MAX_PLAYERS && slot != INPUT_MAX_ACTIONS && players_[player].actions.triggered.Test(slot);
+}
+
+bool Input::IsPlayerActionPressed(unsigned player, ActionID action)
+{
+	unsigned slot = FindAction(action, false);
+	return player < INPUT_MAX_PLAYERS && slot != INPUT_MAX_ACTIONS && players_[player].actions.pressed.Test(slot);
+}
+
+bool Input::IsPlayerActionReleased(unsigned player, ActionID action)
+{
+	unsigned slot = FindAction(action, false);
+	return player < INPUT_MAX_PLAYERS && slot != INPUT_MAX_ACTIONS && players_[player].actions.released.Test(slot);
+}
+
+bool Input::IsPlayerButtonTriggered(unsigned player, SDL_GameControllerButton btn)
+{
+	const int pad = GetPlayerController(player);
+	return pad >= 0 && gp_[pad].triggered.Test(btn);
+}
+
+bool Input::IsPlayerButtonPressed(unsigned player, SDL_GameControllerButton btn)
+{
+	const int pad = GetPlayerController(player);
+	return pad >= 0 && gp_[pad].pressed.Test(btn);
+}
+
+bool Input::IsPlayerButtonReleased(unsigned player, SDL_GameControllerButton btn)
+{
+	const int pad = GetPlayerController(player);
+	return pad >= 0 && gp_[pad].released.Test(btn);
+}
+
+float Input::PlayerAxisValue(unsigned player, SDL_GameControllerAxis axis)
+{
+	const int pad = GetPlayerController(player);
+	return (pad >= 0) ? gp_axes_[axis][pad] : 0.0f;
+}
+
+void Input::UpdatePlayers()
+{
+	players_joined_ = 0;
+
+	//Controllers move between slots and go away, find them once here so
+	//every query after this is an index
+	for (unsigned p = 0; p < INPUT_MAX_PLAYERS; ++p)
+		players_[p].pad = (players_[p].pad_id >= 0) ? GetControllerSlot(players_[p].pad_id) : -1;
+
+	if (join_on_press_)
+		JoinOnPress();
+
+	InputBits<INPUT_MAX_ACTIONS> down;
+
+	for (unsigned p = 0; p < INPUT_MAX_PLAYERS; ++p)
+	{
+		Player & pl = players_[p];
+		if (!pl.joined)
+			continue;
+
+		const unsigned first_pad = (pl.pad >= 0) ? static_cast<unsigned>(pl.pad) : 0;
+		const unsigned last_pad = (pl.pad >= 0) ? first_pad + 1 : 0;
+
+		down.Clear();
+		for (unsigned i = 0; i < binding_count_; ++i)
+			if (IsBindingDown(bindings_[i], first_pad, last_pad, pl.keyboard))
+				down.Set(bindings_[i].slot, true);
+
+		SetActions(pl.actions, down);
+	}
+}
+
+void Input::JoinOnPress()
+{
+	bool keyboard_taken = false;
+	for (unsigned p = 0; p < INPUT_MAX_PLAYERS; ++p)
+		keyboard_taken |= players_[p].keyboard;
+
+	if (!keyboard_taken && (kb_.triggered.Any() || m_.triggered.Any()))
+	{
+		for (unsigned p = 0; p < INPUT_MAX_PLAYERS; ++p)
+		{
+			if (!players_[p].joined)
+			{
+				AssignKeyboard(p);
+				break;
+			}
+		}
+	}
+
+	for (unsigned c = 0; c < gp_slot_ids_.size(); ++c)
+	{
+		if (gp_slot_ids_[c] < 0 || !gp_[c].triggered.Any() || GetControllerPlayer(c) >= 0)
+			continue;
+
+		//Players whose controller was unplugged get the first one back
+		unsigned seat = INPUT_MAX_PLAYERS;
+		for (unsigned p = 0; p < INPUT_MAX_PLAYERS && seat == INPUT_MAX_PLAYERS; ++p)
+			if (players_[p].joined && players_[p].pad_id >= 0 && players_[p].pad < 0)
+				seat = p;
+
+		for (unsigned p = 0; p < INPUT_MAX_PLAYERS && seat == INPUT_MAX_PLAYERS; ++p)
+			if (!players_[p].joined)
+				seat = p;
+
+		if (seat == INPUT_MAX_PLAYERS)
+			return;
+
+		AssignController(seat, c);
+	}
+}
+
+bool Input::JoinPlayer(unsigned player)
+{
+	Player & pl = players_[player];
+	if (pl.joined)
+		return false;
+
+	pl.joined = true;
+	pl.actions.Clear();
+	players_joined_ |= Uint32(1) << player;
+	return true;
+}
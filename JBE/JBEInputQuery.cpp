@@ -0,0 +1,154 @@
+#include "JBEInputQuery.h"
+
+#include <cstring>
+
+namespace
+{
+	static_assert(INPUT_QUERY_MAX <= 64, "query results are 64 bit masks");
+	static_assert(SDL_CONTROLLER_BUTTON_MAX <= 64 && Input::MOUSE_NUMBTNS < 64,
+		"pad and mouse masks are a single word");
+
+	/*
+	*	\brief	Moves each set bit of 'active' to its result bit
+	*/
+	Uint64 Gather(Uint64 active, const Uint8 * bits)
+	{
+		Uint64 out = 0;
+
+		for (unsigned b = 0; active != 0; ++b, active >>= 1)
+			if (active & 1)
+				out |= Uint64(1) << bits[b];
+
+		return out;
+	}
+}
+
+InputQuery::InputQuery()
+{
+	Clear();
+}
+
+int InputQuery::AddKey(SDL_Scancode sc)
+{
+	if (static_cast<unsigned>(sc) >= SDL_NUM_SCANCODES)
+		return -1;
+
+	return Add(kb_mask_.words[sc >> 6], kb_bits_[sc], sc);
+}
+
+int InputQuery::AddMouseButton(Input::MOUSE_BTN m)
+{
+	if (static_cast<unsigned>(m) > Input::MOUSE_NUMBTNS)
+		return -1;
+
+	return Add(m_mask_, m_bits_[m], m);
+}
+
+int InputQuery::AddGamePadButton(SDL_GameControllerButton btn, int which)
+{
+	if (static_cast<unsigned>(btn) >= SDL_CONTROLLER_BUTTON_MAX)
+		return -1;
+
+	if (which < 0)
+		which = -1;
+
+	//One mask per controller named in the query, usually just 'any'
+	unsigned p = 0;
+	while (p < pads_.size() && pads_[p].which != which)
+		++p;
+
+	if (p == pads_.size())
+	{
+		if (count_ == INPUT_QUERY_MAX)
+			return -1;
+
+		PadMask pad;
+		pad.which = which;
+		pad.mask = 0;
+		std::memset(pad.bits, 0, sizeof(pad.bits));
+		pads_.push_back(pad);
+	}
+
+	return Add(pads_[p].mask, pads_[p].bits[btn], btn);
+}
+
+unsigned InputQuery::GetCount() const
+{
+	return count_;
+}
+
+void InputQuery::Clear()
+{
+	count_ = 0;
+
+	kb_mask_.Clear();
+	std::memset(kb_bits_, 0, sizeof(kb_bits_));
+
+	m_mask_ = 0;
+	std::memset(m_bits_, 0, sizeof(m_bits_));
+
+	pads_.clear();
+}
+
+int InputQuery::Add(Uint64 & mask, Uint8 & bit, unsigned i)
+{
+	const Uint64 flag = Uint64(1) << (i & 63);
+
+	if (mask & flag)
+		return bit;
+
+	if (count_ == INPUT_QUERY_MAX)
+		return -1;
+
+	mask |= flag;
+	bit = static_cast<Uint8>(count_);
+	return count_++;
+}
+
+void Input::Query(const InputQuery & query, QueryResult & result)
+{
+	result.triggered = result.pressed = result.released = 0;
+
+	for (unsigned w = 0; w < InputBits<SDL_NUM_SCANCODES>::WORDS; ++w)
+	{
+		const Uint64 mask = query.kb_mask_.words[w];
+		const Uint64 t = kb_.triggered.words[w] & mask;
+		const Uint64 p = kb_.pressed.words[w] & mask;
+		const Uint64 r = kb_.released.words[w] & mask;
+
+		if ((t | p | r) == 0)
+			continue;
+
+		result.triggered |= Gather(t, query.kb_bits_ + w * 64);
+		result.pressed |= Gather(p, query.kb_bits_ + w * 64);
+		result.released |= Gather(r, query.kb_bits_ + w * 64);
+	}
+
+	if (query.m_mask_ != 0)
+	{
+		result.triggered |= Gather(m_.triggered.words[0] & query.m_mask_, query.m_bits_);
+		result.pressed |= Gather(m_.pressed.words[0] & query.m_mask_, query.m_bits_);
+		result.released |= Gather(m_.released.words[0] & query.m_mask_, query.m_bits_);
+	}
+
+	const unsigned count = static_cast<unsigned>(gp_.size());
+
+	for (unsigned i = 0; i < query.pads_.size(); ++i)
+	{
+		const InputQuery::PadMask & pad = query.pads_[i];
+		unsigned first = (pad.which < 0) ? 0 : pad.which;
+		unsigned last = (pad.which < 0 || pad.which + 1u > count) ? count : pad.which + 1;
+
+		Uint64 t = 0, p = 0, r = 0;
+		for (unsigned c = first; c < last; ++c)
+		{
+			t |= gp_[c].triggered.words[0];
+			p |= gp_[c].pressed.words[0];
+			r |= gp_[c].released.words[0];
+		}
+
+		result.triggered |= Gather(t & pad.mask, pad.bits);
+		result.pressed |= Gather(p & pad.mask, pad.bits);
+		result.released |= Gather(r & pad.mask, pad.bits);
+	}
+}
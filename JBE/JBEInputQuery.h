@@ -0,0 +1,81 @@
+#pragma once
+#define INPUT_QUERY_MAX 64
+
+#include "JBEInput.h"
+
+#include <SDL.h>
+#include <vector>
+
+/*
+*	\name	InputQuery
+*
+*	\brief	Set of keys and buttons evaluated together by Input::Query.
+*
+*	\detail	Each key or button added gets a bit of the result, in the
+*			order they were added. The set is compiled into one mask per
+*			device as it is built, so evaluating it is a few AND over
+*			the device state, and only the inputs that are active get
+*			mapped back to their result bit. Build queries once, e.g.
+*			when loading the bindings, and keep them around.
+*/
+class InputQuery
+{
+public:
+	InputQuery();
+
+	/*
+	*	\brief	Adds the keyboard key 'sc' to the query
+	*
+	*	\returns	The result bit of the key, or -1 if the query already
+	*				holds INPUT_QUERY_MAX inputs.
+	*/
+	int AddKey(SDL_Scancode sc);
+
+	/*
+	*	\brief	Adds the mouse button 'm' to the query. See AddKey.
+	*/
+	int AddMouseButton(Input::MOUSE_BTN m);
+
+	/*
+	*	\brief	Adds the game pad button 'btn' of the controller 'which' to
+	*			the query, any controller when 'which' is negative. See
+	*			AddKey.
+	*/
+	int AddGamePadButton(SDL_GameControllerButton btn, int which = -1);
+
+	/*
+	*	\brief	Returns how many inputs the query holds
+	*/
+	unsigned GetCount() const;
+
+	/*
+	*	\brief	Removes every input
+	*/
+	void Clear();
+
+private:
+	friend class Input;
+
+	/*
+	*	\brief	Buttons of one controller (or any, 'which' -1) and their
+	*			result bits
+	*/
+	struct PadMask
+	{
+		int which;
+		Uint64 mask;
+		Uint8 bits[SDL_CONTROLLER_BUTTON_MAX];
+	};
+
+	int Add(Uint64 &mask, Uint8 &bit, unsigned i);
+
+	unsigned count_;
+
+	InputBits<SDL_NUM_SCANCODES> kb_mask_;
+	Uint8 kb_bits_[SDL_NUM_SCANCODES];
+
+	Uint64 m_mask_;
+	Uint8 m_bits_[Input::MOUSE_NUMBTNS + 1];
+
+	std::vector<PadMask> pads_;
+};
@@ -0,0 +1,99 @@
+#pragma once
+#define INPUT_CACHE_LINE 64
+
+#include <atomic>
+
+/*
+*	\name	SPSCQueue
+*
+*	\brief	Fixed capacity ring buffer for exactly one producer thread and
+*			one consumer thread.
+*
+*	\detail	Push and Pop never block and never allocate, a full queue makes
+*			Push fail and an empty one makes Pop fail. The producer and
+*			consumer indices live on separate cache lines, each next to a
+*			cached copy of the other side's index, so in the common case
+*			neither thread touches the other's line.
+*			Capacity must be a power of two.
+*/
+template <typename T, unsigned Capacity>
+class SPSCQueue
+{
+	static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+		"SPSCQueue capacity must be a power of two");
+
+public:
+	SPSCQueue() : head_(0), tail_cache_(0), tail_(0), head_cache_(0) {}
+
+	SPSCQueue(const SPSCQueue &) = delete;
+	SPSCQueue & operator=(const SPSCQueue &) = delete;
+
+	/*
+	*	\brief	Copies 'item' into the queue. Producer thread only.
+	*
+	*	\retval	true	The item was queued.
+	*	\retval	false	The queue was full, nothing was written.
+	*/
+	bool Push(const T & item)
+	{
+		const unsigned tail = tail_.load(std::memory_order_relaxed);
+
+		if (tail - head_cache_ == Capacity)
+		{
+			head_cache_ = head_.load(std::memory_order_acquire);
+			if (tail - head_cache_ == Capacity)
+				return false;
+		}
+
+		items_[tail & (Capacity - 1)] = item;
+		tail_.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	/*
+	*	\brief	Moves the oldest item of the queue into 'item'. Consumer
+	*			thread only.
+	*
+	*	\retval	true	'item' was written.
+	*	\retval	false	The queue was empty.
+	*/
+	bool Pop(T & item)
+	{
+		const unsigned head = head_.load(std::memory_order_relaxed);
+
+		if (head == tail_cache_)
+		{
+			tail_cache_ = tail_.load(std::memory_order_acquire);
+			if (head == tail_cache_)
+				return false;
+		}
+
+		item = items_[head & (Capacity - 1)];
+		head_.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	/*
+	*	\brief	Approximate amount of queued items, exact only when called
+	*			while neither side is running.
+	*/
+	unsigned Size() const
+	{
+		return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+	}
+
+private:
+	/*
+	*	\brief	Consumer side: read index and the last tail it saw
+	*/
+	alignas(INPUT_CACHE_LINE) std::atomic<unsigned> head_;
+	unsigned tail_cache_;
+
+	/*
+	*	\brief	Producer side: write index and the last head it saw
+	*/
+	alignas(INPUT_CACHE_LINE) std::atomic<unsigned> tail_;
+	unsigned head_cache_;
+
+	alignas(INPUT_CACHE_LINE) T items_[Capacity];
+};
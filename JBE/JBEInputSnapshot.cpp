@@ -0,0 +1,257 @@
+#include "JBEInputSnapshot.h"
+
+#include <cstring>
+
+//Static vars
+InputSnapshot Input::snapshots_[INPUT_SNAPSHOT_POOL];
+std::atomic<InputSnapshot *> Input::snapshot_(nullptr);
+
+namespace
+{
+	static_assert(INPUT_SNAPSHOT_POOL >= 2,
+		"Update needs a buffer to fill besides the published one");
+
+	template <unsigned Bits>
+	bool Triggered(const InputBits<Bits> & down, const InputBits<Bits> & prev, unsigned i)
+	{
+		return down.Test(i) && !prev.Test(i);
+	}
+
+	template <unsigned Bits>
+	bool Pressed(const InputBits<Bits> & down, const InputBits<Bits> & prev, unsigned i)
+	{
+		return down.Test(i) && prev.Test(i);
+	}
+
+	template <unsigned Bits>
+	bool Released(const InputBits<Bits> & down, const InputBits<Bits> & prev, unsigned i)
+	{
+		return !down.Test(i) && prev.Test(i);
+	}
+}
+
+const InputSnapshot * Input::AcquireSnapshot()
+{
+	for (;;)
+	{
+		InputSnapshot * snapshot = snapshot_.load();
+		if (snapshot == nullptr)
+			return nullptr;
+
+		//Only keep it if it was still the published one after counting
+		//ourselves in, otherwise Update may be refilling it
+		snapshot->refs_.fetch_add(1);
+		if (snapshot_.load() == snapshot)
+			return snapshot;
+
+		snapshot->refs_.fetch_sub(1);
+	}
+}
+
+void Input::ReleaseSnapshot(const InputSnapshot * snapshot)
+{
+	if (snapshot)
+		snapshot->refs_.fetch_sub(1);
+}
+
+void Input::PublishSnapshot()
+{
+	InputSnapshot * current = snapshot_.load();
+	InputSnapshot * s = nullptr;
+
+	for (unsigned i = 0; i < INPUT_SNAPSHOT_POOL && s == nullptr; ++i)
+		if (&snapshots_[i] != current && snapshots_[i].refs_.load() == 0)
+			s = &snapshots_[i];
+
+	//Readers are holding every buffer, the last snapshot stays up
+	if (s == nullptr)
+		return;
+
+	s->frame_ = frame_count_;
+	s->time_ = frame_time_;
+
+	s->kb_down_ = kb_.down;
+	s->kb_prev_ = kb_.prev;
+
+	s->m_down_ = m_.down;
+	s->m_prev_ = m_.prev;
+	s->m_x_ = m_frame_.x;
+	s->m_y_ = m_frame_.y;
+	s->m_dx_ = m_frame_.dx;
+	s->m_dy_ = m_frame_.dy;
+	s->m_wheel_x_ = m_frame_.wheel_x;
+	s->m_wheel_y_ = m_frame_.wheel_y;
+
+	//Vectors only grow, so a snapshot allocates when controllers are added
+	const size_t count = gp_.size();
+	s->gp_ids_.assign(gp_slot_ids_.begin(), gp_slot_ids_.end());
+	s->gp_down_.resize(count);
+	s->gp_prev_.resize(count);
+	s->gp_combos_.resize(count);
+
+	for (size_t c = 0; c < count; ++c)
+	{
+		s->gp_down_[c] = gp_[c].down;
+		s->gp_prev_[c] = gp_[c].prev;
+		s->gp_combos_[c] = gp_combos_[c].triggered;
+	}
+
+	for (unsigned a = 0; a < SDL_CONTROLLER_AXIS_MAX; ++a)
+		s->gp_axes_[a].assign(gp_axes_[a].begin(), gp_axes_[a].end());
+
+	s->act_down_ = actions_.down;
+	s->act_prev_ = actions_.prev;
+	std::memcpy(s->action_ids_, action_ids_, sizeof(action_ids_));
+	std::memcpy(s->action_slots_, action_slots_, sizeof(action_slots_));
+
+	snapshot_.store(s);
+}
+
+InputSnapshot::InputSnapshot() : frame_(0), time_(0),
+	m_x_(0), m_y_(0), m_dx_(0), m_dy_(0), m_wheel_x_(0), m_wheel_y_(0), refs_(0)
+{
+	kb_down_.Clear();
+	kb_prev_.Clear();
+	m_down_.Clear();
+	m_prev_.Clear();
+	act_down_.Clear();
+	act_prev_.Clear();
+	std::memset(action_ids_, 0, sizeof(action_ids_));
+	std::memset(action_slots_, 0, sizeof(action_slots_));
+}
+
+Uint64 InputSnapshot::GetFrame() const
+{
+	return frame_;
+}
+
+Uint64 InputSnapshot::GetFrameTime() const
+{
+	return time_;
+}
+
+bool InputSnapshot::IsKeyTriggered(SDL_Scancode sc) const
+{
+	return Triggered(kb_down_, kb_prev_, sc);
+}
+
+bool InputSnapshot::IsKeyPressed(SDL_Scancode sc) const
+{
+	return Pressed(kb_down_, kb_prev_, sc);
+}
+
+bool InputSnapshot::IsKeyReleased(SDL_Scancode sc) const
+{
+	return Released(kb_down_, kb_prev_, sc);
+}
+
+bool InputSnapshot::IsMouseButtonTriggered(Input::MOUSE_BTN m) const
+{
+	return Triggered(m_down_, m_prev_, m);
+}
+
+bool InputSnapshot::IsMouseButtonPressed(Input::MOUSE_BTN m) const
+{
+	return Pressed(m_down_, m_prev_, m);
+}
+
+bool InputSnapshot::IsMouseButtonReleased(Input::MOUSE_BTN m) const
+{
+	return Released(m_down_, m_prev_, m);
+}
+
+int InputSnapshot::GetMousePosX() const
+{
+	return m_x_;
+}
+
+int InputSnapshot::GetMousePosY() const
+{
+	return m_y_;
+}
+
+int InputSnapshot::GetMouseDeltaX() const
+{
+	return m_dx_;
+}
+
+int InputSnapshot::GetMouseDeltaY() const
+{
+	return m_dy_;
+}
+
+int InputSnapshot::GetMouseWheelDelta() const
+{
+	return m_wheel_y_;
+}
+
+int InputSnapshot::GetMouseWheelDeltaX() const
+{
+	return m_wheel_x_;
+}
+
+bool InputSnapshot::IsControllerActive(unsigned which) const
+{
+	return which < gp_ids_.size() && gp_ids_[which] >= 0;
+}
+
+bool InputSnapshot::IsGamePadTriggered(unsigned which, SDL_GameControllerButton btn) const
+{
+	return which < gp_down_.size() && Triggered(gp_down_[which], gp_prev_[which], btn);
+}
+
+bool InputSnapshot::IsGamePadPressed(unsigned which, SDL_GameControllerButton btn) const
+{
+	return which < gp_down_.size() && Pressed(gp_down_[which], gp_prev_[which], btn);
+}
+
+bool InputSnapshot::IsGamePadReleased(unsigned which, SDL_GameControllerButton btn) const
+{
+	return which < gp_down_.size() && Released(gp_down_[which], gp_prev_[which], btn);
+}
+
+float InputSnapshot::GamePadAxisValue(unsigned which, SDL_GameControllerAxis axis) const
+{
+	return (which < gp_axes_[axis].size()) ? gp_axes_[axis][which] : 0.0f;
+}
+
+bool InputSnapshot::IsComboTriggered(unsigned which, unsigned combo) const
+{
+	return which < gp_combos_.size() && combo < INPUT_MAX_COMBOS && gp_combos_[which].Test(combo);
+}
+
+bool InputSnapshot::IsActionTriggered(Input::ActionID action) const
+{
+	unsigned slot = FindAction(action);
+	return slot != INPUT_MAX_ACTIONS && Triggered(act_down_, act_prev_, slot);
+}
+
+bool InputSnapshot::IsActionPressed(Input::ActionID action) const
+{
+	unsigned slot = FindAction(action);
+	return slot != INPUT_MAX_ACTIONS && Pressed(act_down_, act_prev_, slot);
+}
+
+bool InputSnapshot::IsActionReleased(Input::ActionID action) const
+{
+	unsigned slot = FindAction(action);
+	return slot != INPUT_MAX_ACTIONS && Released(act_down_, act_prev_, slot);
+}
+
+unsigned InputSnapshot::FindAction(Input::ActionID action) const
+{
+	if (action == 0)
+		return INPUT_MAX_ACTIONS;
+
+	//Same probing as Input::FindAction, over this frame's copy of the table
+	const unsigned mask = INPUT_MAX_ACTIONS * 2 - 1;
+
+	for (unsigned i = action & mask;; i = (i + 1) & mask)
+	{
+		if (action_ids_[i] == action)
+			return action_slots_[i];
+
+		if (action_ids_[i] == 0)
+			return INPUT_MAX_ACTIONS;
+	}
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "JBEInput.h"
+
+#include <SDL.h>
+#include <atomic>
+#include <vector>
+
+/*
+*	\name	InputSnapshot
+*
+*	\brief	Immutable copy of the input state of one frame, safe to read
+*			from any thread. See Input::AcquireSnapshot.
+*
+*	\detail	Only the 'down' bits of this frame and the previous one are
+*			kept, the triggered/pressed/released states are derived from
+*			them on each query, plus the filtered axes, the mouse and the
+*			actions. The queries mirror the ones in Input.
+*/
+class InputSnapshot
+{
+public:
+	InputSnapshot();
+
+	InputSnapshot(const InputSnapshot &) = delete;
+	InputSnapshot & operator=(const InputSnapshot &) = delete;
+
+	/*
+	*	\brief	Returns how many times Input::Update had run when this
+	*			snapshot was published, 0 for the one published by Init
+	*/
+	Uint64 GetFrame() const;
+
+	/*
+	*	\brief	Returns the SDL_GetPerformanceCounter value of this frame's
+	*			Update, see Input::GetFrameTime
+	*/
+	Uint64 GetFrameTime() const;
+
+	bool IsKeyTriggered(SDL_Scancode sc) const;
+	bool IsKeyPressed(SDL_Scancode sc) const;
+	bool IsKeyReleased(SDL_Scancode sc) const;
+
+	bool IsMouseButtonTriggered(Input::MOUSE_BTN m) const;
+	bool IsMouseButtonPressed(Input::MOUSE_BTN m) const;
+	bool IsMouseButtonReleased(Input::MOUSE_BTN m) const;
+
+	int GetMousePosX() const;
+	int GetMousePosY() const;
+	int GetMouseDeltaX() const;
+	int GetMouseDeltaY() const;
+	int GetMouseWheelDelta() const;
+	int GetMouseWheelDeltaX() const;
+
+	/*
+	*	\brief	Returns whether a controller was plugged into the slot
+	*			'which' this frame
+	*/
+	bool IsControllerActive(unsigned which) const;
+
+	bool IsGamePadTriggered(unsigned which, SDL_GameControllerButton btn) const;
+	bool IsGamePadPressed(unsigned which, SDL_GameControllerButton btn) const;
+	bool IsGamePadReleased(unsigned which, SDL_GameControllerButton btn) const;
+
+	/*
+	*	\brief	Returns the filtered value of 'axis' on the controller 'which'
+	*/
+	float GamePadAxisValue(unsigned which, SDL_GameControllerAxis axis) const;
+
+	/*
+	*	\brief	Returns whether the controller 'which' completed the combo
+	*			'combo' this frame, see Input::AddCombo
+	*/
+	bool IsComboTriggered(unsigned which, unsigned combo) const;
+
+	bool IsActionTriggered(Input::ActionID action) const;
+	bool IsActionPressed(Input::ActionID action) const;
+	bool IsActionReleased(Input::ActionID action) const;
+
+private:
+	friend class Input;
+
+	/*
+	*	\brief	Slot of 'action' in this frame's action table, or
+	*			INPUT_MAX_ACTIONS
+	*/
+	unsigned FindAction(Input::ActionID action) const;
+
+	Uint64 frame_;
+	Uint64 time_;
+
+	InputBits<SDL_NUM_SCANCODES> kb_down_;
+	InputBits<SDL_NUM_SCANCODES> kb_prev_;
+
+	InputBits<Input::MOUSE_NUMBTNS + 1> m_down_;
+	InputBits<Input::MOUSE_NUMBTNS + 1> m_prev_;
+	int m_x_, m_y_, m_dx_, m_dy_, m_wheel_x_, m_wheel_y_;
+
+	std::vector<SDL_JoystickID> gp_ids_;
+	std::vector<InputBits<SDL_CONTROLLER_BUTTON_MAX>> gp_down_;
+	std::vector<InputBits<SDL_CONTROLLER_BUTTON_MAX>> gp_prev_;
+	std::vector<float> gp_axes_[SDL_CONTROLLER_AXIS_MAX];
+	std::vector<InputBits<INPUT_MAX_COMBOS>> gp_combos_;
+
+	InputBits<INPUT_MAX_ACTIONS> act_down_;
+	InputBits<INPUT_MAX_ACTIONS> act_prev_;
+	Input::ActionID action_ids_[INPUT_MAX_ACTIONS * 2];
+	Uint8 action_slots_[INPUT_MAX_ACTIONS * 2];
+
+	/*
+	*	\brief	Readers holding this snapshot, Update only refills a
+	*			snapshot nobody holds
+	*/
+	mutable std::atomic<unsigned> refs_;
+};
@@ -0,0 +1,202 @@
+#include "JBEInput.h"
+
+#include <cstring>
+
+//Static vars
+Input::TextBuffer Input::text_live_;
+Input::TextBuffer Input::text_frame_;
+unsigned Input::text_dropped_ = 0;
+
+namespace
+{
+	//Marks the record that starts a composition, 'which' and 'value' hold
+	//the cursor and selection instead of text
+	const Uint16 TEXT_BEGIN = 0x8000;
+	const unsigned CHUNK = 2 * sizeof(Sint32);
+
+	static_assert(INPUT_COMPOSITION_CAPACITY >= SDL_TEXTEDITINGEVENT_TEXT_SIZE,
+		"a whole composition has to fit");
+
+	/*
+	*	\brief	Returns how many bytes of 'text' end in a whole UTF-8
+	*			character, at most 'size'
+	*/
+	unsigned CompleteSize(const char * text, unsigned size)
+	{
+		//Find the lead byte of the last character, at most 3 bytes back
+		unsigned lead = size;
+		while (lead > 0 && size - lead < 4 && (text[lead - 1] & 0xC0) == 0x80)
+			--lead;
+
+		if (lead == 0)
+			return 0;
+
+		const unsigned char c = static_cast<unsigned char>(text[lead - 1]);
+		const unsigned length = (c < 0x80) ? 1 : (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3 : 2;
+
+		return (lead - 1 + length <= size) ? size : lead - 1;
+	}
+
+	/*
+	*	\brief	Appends 'count' bytes to 'buffer', dropping whatever does
+	*			not fit and everything after it
+	*/
+	void Append(char * buffer, unsigned capacity, unsigned & size, bool & overflow,
+		unsigned & dropped, const char * bytes, unsigned count)
+	{
+		if (overflow || size + count > capacity)
+		{
+			overflow = true;
+			dropped += count;
+			return;
+		}
+
+		std::memcpy(buffer + size, bytes, count);
+		size += count;
+	}
+}
+
+void Input::StartTextInput()
+{
+	SDL_StartTextInput();
+}
+
+void Input::StopTextInput()
+{
+	SDL_StopTextInput();
+}
+
+bool Input::IsTextInputActive()
+{
+	return SDL_IsTextInputActive() == SDL_TRUE;
+}
+
+void Input::SetTextInputRect(int x, int y, int w, int h)
+{
+	SDL_Rect rect = { x, y, w, h };
+	SDL_SetTextInputRect(&rect);
+}
+
+Input::TextView Input::GetText()
+{
+	TextView view = { text_frame_.text, text_frame_.text_size };
+	return view;
+}
+
+Input::TextView Input::GetComposition()
+{
+	TextView view = { text_frame_.composition, text_frame_.composition_size };
+	return view;
+}
+
+int Input::GetCompositionCursor()
+{
+	return text_frame_.cursor;
+}
+
+int Input::GetCompositionSelection()
+{
+	return text_frame_.selection;
+}
+
+unsigned Input::GetDroppedText()
+{
+	return text_dropped_;
+}
+
+void Input::SubmitText(const SDL_Event * ev)
+{
+	const char * text;
+	unsigned size;
+	Record rec;
+
+	if (ev->type == SDL_TEXTEDITING)
+	{
+		text = ev->edit.text;
+		size = static_cast<unsigned>(std::strlen(text));
+
+		rec.type = SDL_TEXTEDITING;
+		rec.code = TEXT_BEGIN;
+		rec.which = ev->edit.start;
+		rec.value = ev->edit.length;
+		StampRecord(rec, ev->edit.timestamp);
+		SubmitRecord(rec);
+	}
+	else
+	{
+		text = ev->text.text;
+		size = static_cast<unsigned>(std::strlen(text));
+
+		rec.type = SDL_TEXTINPUT;
+		StampRecord(rec, ev->text.timestamp);
+	}
+
+	for (unsigned i = 0; i < size; i += CHUNK)
+	{
+		const unsigned count = (size - i < CHUNK) ? size - i : CHUNK;
+		char bytes[CHUNK] = { 0 };
+		std::memcpy(bytes, text + i, count);
+
+		rec.code = static_cast<Uint16>(count);
+		std::memcpy(&rec.which, bytes, sizeof(rec.which));
+		std::memcpy(&rec.value, bytes + sizeof(rec.which), sizeof(rec.value));
+		SubmitRecord(rec);
+	}
+}
+
+bool Input::HandleTextEvent(const Record & rec)
+{
+	if (rec.type != SDL_TEXTINPUT && rec.type != SDL_TEXTEDITING)
+		return false;
+
+	//A new composition replaces the last one
+	if (rec.code == TEXT_BEGIN)
+	{
+		text_live_.composition_size = 0;
+		text_live_.cursor = rec.which;
+		text_live_.selection = rec.value;
+		return true;
+	}
+
+	char bytes[CHUNK];
+	std::memcpy(bytes, &rec.which, sizeof(rec.which));
+	std::memcpy(bytes + sizeof(rec.which), &rec.value, sizeof(rec.value));
+	const unsigned count = (rec.code < CHUNK) ? rec.code : CHUNK;
+
+	//Never set, every composition fits (see the static_assert)
+	bool composition_overflow = false;
+
+	if (rec.type == SDL_TEXTINPUT)
+		Append(text_live_.text, INPUT_TEXT_CAPACITY, text_live_.text_size, text_live_.overflow, text_dropped_, bytes, count);
+	else
+		Append(text_live_.composition, INPUT_COMPOSITION_CAPACITY, text_live_.composition_size, composition_overflow, text_dropped_, bytes, count);
+
+	return true;
+}
+
+void Input::UpdateText()
+{
+	//A character can be split between this frame and the next one in
+	//deferred mode, its first bytes wait in 'live'
+	unsigned complete = CompleteSize(text_live_.text, text_live_.text_size);
+	unsigned rest = text_live_.text_size - complete;
+
+	if (text_live_.overflow)
+	{
+		text_dropped_ += rest;
+		rest = 0;
+	}
+
+	std::memcpy(text_frame_.text, text_live_.text, complete);
+	text_frame_.text_size = complete;
+
+	std::memmove(text_live_.text, text_live_.text + complete, rest);
+	text_live_.text_size = rest;
+	text_live_.overflow = false;
+
+	complete = CompleteSize(text_live_.composition, text_live_.composition_size);
+	std::memcpy(text_frame_.composition, text_live_.composition, complete);
+	text_frame_.composition_size = complete;
+	text_frame_.cursor = text_live_.cursor;
+	text_frame_.selection = text_live_.selection;
+}
@@ -0,0 +1,140 @@
+#include "JBEInput.h"
+
+namespace
+{
+	/*
+	*	\brief	How many times a button held for 'held' ticks has repeated
+	*/
+	Uint64 RepeatCount(Uint64 held, Uint64 delay, Uint64 interval)
+	{
+		if (held < delay)
+			return 0;
+
+		return (interval != 0) ? 1 + (held - delay) / interval : 1;
+	}
+
+	/*
+	*	\brief	Ticks button 'i' has been down as of 'now', 0 while it is up
+	*/
+	template <unsigned Bits>
+	Uint64 HoldTicks(const ButtonStates<Bits> & states, unsigned i, Uint64 now)
+	{
+		if (!states.down.Test(i) || now < states.down_at[i])
+			return 0;
+
+		return now - states.down_at[i];
+	}
+
+	template <unsigned Bits>
+	bool IsDoubleTap(const ButtonStates<Bits> & states, unsigned i, Uint64 window)
+	{
+		return states.triggered.Test(i) && states.last_down_at[i] != 0 &&
+			states.down_at[i] - states.last_down_at[i] <= window;
+	}
+
+	/*
+	*	\brief	Whether a repeat falls between the last frame and this one
+	*/
+	template <unsigned Bits>
+	bool IsRepeat(const ButtonStates<Bits> & states, unsigned i, Uint64 prev, Uint64 now, Uint64 delay, Uint64 interval)
+	{
+		if (states.triggered.Test(i))
+			return true;
+
+		if (!states.pressed.Test(i))
+			return false;
+
+		return RepeatCount(HoldTicks(states, i, now), delay, interval) >
+			RepeatCount(HoldTicks(states, i, prev), delay, interval);
+	}
+}
+
+double Input::GetKeyHoldTime(SDL_Scancode sc)
+{
+	return CounterToSeconds(HoldTicks(kb_, sc, frame_time_));
+}
+
+bool Input::IsKeyHeld(SDL_Scancode sc, double seconds)
+{
+	return kb_.down.Test(sc) && HoldTicks(kb_, sc, frame_time_) >= SecondsToCounter(seconds);
+}
+
+bool Input::IsKeyDoubleTapped(SDL_Scancode sc, double window)
+{
+	return IsDoubleTap(kb_, sc, SecondsToCounter(window));
+}
+
+bool Input::IsKeyRepeated(SDL_Scancode sc, double delay, double interval)
+{
+	return IsRepeat(kb_, sc, prev_frame_time_, frame_time_, SecondsToCounter(delay), SecondsToCounter(interval));
+}
+
+double Input::GetMouseButtonHoldTime(MOUSE_BTN m)
+{
+	return CounterToSeconds(HoldTicks(m_, m, frame_time_));
+}
+
+bool Input::IsMouseButtonHeld(MOUSE_BTN m, double seconds)
+{
+	return m_.down.Test(m) && HoldTicks(m_, m, frame_time_) >= SecondsToCounter(seconds);
+}
+
+bool Input::IsMouseButtonDoubleTapped(MOUSE_BTN m, double window)
+{
+	return IsDoubleTap(m_, m, SecondsToCounter(window));
+}
+
+bool Input::IsMouseButtonRepeated(MOUSE_BTN m, double delay, double interval)
+{
+	return IsRepeat(m_, m, prev_frame_time_, frame_time_, SecondsToCounter(delay), SecondsToCounter(interval));
+}
+
+double Input::GetGamePadHoldTime(unsigned which, SDL_GameControllerButton btn)
+{
+	if (which >= gp_.size())
+		return 0.0;
+
+	return CounterToSeconds(HoldTicks(gp_[which], btn, frame_time_));
+}
+
+bool Input::IsGamePadHeld(unsigned which, SDL_GameControllerButton btn, double seconds)
+{
+	return which < gp_.size() && gp_[which].down.Test(btn) && HoldTicks(gp_[which], btn, frame_time_) >= SecondsToCounter(seconds);
+}
+
+bool Input::IsGamePadDoubleTapped(unsigned which, SDL_GameControllerButton btn, double window)
+{
+	return which < gp_.size() && IsDoubleTap(gp_[which], btn, SecondsToCounter(window));
+}
+
+bool Input::IsGamePadRepeated(unsigned which, SDL_GameControllerButton btn, double delay, double interval)
+{
+	return which < gp_.size() && IsRepeat(gp_[which], btn, prev_frame_time_, frame_time_, SecondsToCounter(delay), SecondsToCounter(interval));
+}
+
+double Input::GetActionHoldTime(ActionID action)
+{
+	unsigned slot = FindAction(action, false);
+	if (slot == INPUT_MAX_ACTIONS)
+		return 0.0;
+
+	return CounterToSeconds(HoldTicks(actions_, slot, frame_time_));
+}
+
+bool Input::IsActionHeld(ActionID action, double seconds)
+{
+	unsigned slot = FindAction(action, false);
+	return slot != INPUT_MAX_ACTIONS && actions_.down.Test(slot) && HoldTicks(actions_, slot, frame_time_) >= SecondsToCounter(seconds);
+}
+
+bool Input::IsActionDoubleTapped(ActionID action, double window)
+{
+	unsigned slot = FindAction(action, false);
+	return slot != INPUT_MAX_ACTIONS && IsDoubleTap(actions_, slot, SecondsToCounter(window));
+}
+
+bool Input::IsActionRepeated(ActionID action, double delay, double interval)
+{
+	unsigned slot = FindAction(action, false);
+	return slot != INPUT_MAX_ACTIONS && IsRepeat(actions_, slot, prev_frame_time_, frame_time_, SecondsToCounter(delay), SecondsToCounter(interval));
+}
@@ -0,0 +1,329 @@
+#include "JBEInput.h"
+
+#include <cmath>
+#include <cstring>
+
+//Static vars
+ButtonStates<INPUT_MAX_FINGERS> Input::touch_;
+Input::TouchFinger Input::touch_live_[INPUT_MAX_FINGERS];
+Input::TouchFinger Input::touch_frame_[INPUT_MAX_FINGERS];
+InputBits<INPUT_MAX_FINGERS> Input::touch_moved_live_;
+InputBits<INPUT_MAX_FINGERS> Input::touch_moved_;
+Uint8 Input::touch_table_[INPUT_MAX_FINGERS * 2];
+Sint32 Input::touch_ids_[INPUT_MAX_FINGERS];
+Input::TouchKey Input::touch_keys_[INPUT_MAX_FINGERS];
+unsigned Input::touch_key_count_ = 0;
+Uint32 Input::touch_next_key_ = 0;
+bool Input::touch_gestures_ = false;
+float Input::touch_aspect_ = 1.0f;
+Input::TouchGesture Input::touch_gesture_ = { 0, 0.0f, 0.0f, 1.0f, 0.0f };
+
+namespace
+{
+	const unsigned TABLE_MASK = INPUT_MAX_FINGERS * 2 - 1;
+	const Uint8 NO_FINGER = INPUT_MAX_FINGERS;
+	const float PI = 3.14159265f;
+
+	static_assert((INPUT_MAX_FINGERS & (INPUT_MAX_FINGERS - 1)) == 0,
+		"INPUT_MAX_FINGERS must be a power of two");
+	static_assert(INPUT_MAX_FINGERS <= 64, "fingers are tracked in one 64 bit word");
+
+	Uint32 ToFraction(float v)
+	{
+		v = (v < 0.0f) ? 0.0f : (v > 1.0f) ? 1.0f : v;
+		return static_cast<Uint32>(v * 65535.0f + 0.5f);
+	}
+
+	float FromFraction(Uint32 v)
+	{
+		return static_cast<float>(v & 0xFFFF) / 65535.0f;
+	}
+}
+
+bool Input::IsTouchTriggered(unsigned finger)
+{
+	return finger < INPUT_MAX_FINGERS && touch_.triggered.Test(finger);
+}
+
+bool Input::IsTouchPressed(unsigned finger)
+{
+	return finger < INPUT_MAX_FINGERS && touch_.pressed.Test(finger);
+}
+
+bool Input::IsTouchReleased(unsigned finger)
+{
+	return finger < INPUT_MAX_FINGERS && touch_.released.Test(finger);
+}
+
+bool Input::IsTouchMoved(unsigned finger)
+{
+	return finger < INPUT_MAX_FINGERS && touch_moved_.Test(finger);
+}
+
+unsigned Input::GetTouchCount()
+{
+	unsigned count = 0;
+	for (Uint64 down = touch_.down.words[0]; down != 0; down &= down - 1)
+		++count;
+
+	return count;
+}
+
+float Input::GetTouchX(unsigned finger)
+{
+	return (finger < INPUT_MAX_FINGERS) ? touch_frame_[finger].x : 0.0f;
+}
+
+float Input::GetTouchY(unsigned finger)
+{
+	return (finger < INPUT_MAX_FINGERS) ? touch_frame_[finger].y : 0.0f;
+}
+
+float Input::GetTouchDeltaX(unsigned finger)
+{
+	return (finger < INPUT_MAX_FINGERS) ? touch_frame_[finger].dx : 0.0f;
+}
+
+float Input::GetTouchDeltaY(unsigned finger)
+{
+	return (finger < INPUT_MAX_FINGERS) ? touch_frame_[finger].dy : 0.0f;
+}
+
+float Input::GetTouchPressure(unsigned finger)
+{
+	return (finger < INPUT_MAX_FINGERS) ? touch_frame_[finger].pressure : 0.0f;
+}
+
+void Input::SetTouchGestures(bool enabled, float aspect)
+{
+	touch_gestures_ = enabled;
+	touch_aspect_ = (aspect > 0.0f) ? aspect : 1.0f;
+
+	TouchGesture none = { 0, 0.0f, 0.0f, 1.0f, 0.0f };
+	touch_gesture_ = none;
+}
+
+const Input::TouchGesture & Input::GetTouchGesture()
+{
+	return touch_gesture_;
+}
+
+bool Input::MakeTouchRecord(const SDL_TouchFingerEvent & ev, Record & rec)
+{
+	//Rarely more than a few fingers are down, a scan beats hashing 128 bits
+	unsigned k = 0;
+	while (k < touch_key_count_ && (touch_keys_[k].touch != ev.touchId || touch_keys_[k].finger != ev.fingerId))
+		++k;
+
+	if (k == touch_key_count_)
+	{
+		if (ev.type != SDL_FINGERDOWN || touch_key_count_ == INPUT_MAX_FINGERS)
+			return false;
+
+		//Sequential keys spread evenly over the slot table. After the
+		//counter wraps, keys still held by a finger are skipped.
+		Sint32 key;
+		for (bool taken = true; taken;)
+		{
+			key = static_cast<Sint32>(touch_next_key_++);
+			taken = false;
+
+			for (unsigned i = 0; i < touch_key_count_; ++i)
+				taken |= (touch_keys_[i].key == key);
+		}
+
+		TouchKey & t = touch_keys_[touch_key_count_++];
+		t.touch = ev.touchId;
+		t.finger = ev.fingerId;
+		t.key = key;
+	}
+
+	rec.which = touch_keys_[k].key;
+	rec.code = static_cast<Uint16>(ToFraction(ev.pressure));
+	rec.value = static_cast<Sint32>((ToFraction(ev.y) << 16) | ToFraction(ev.x));
+
+	if (ev.type == SDL_FINGERUP)
+		touch_keys_[k] = touch_keys_[--touch_key_count_];
+
+	return true;
+}
+
+bool Input::HandleTouchEvent(const Record & rec)
+{
+	if (rec.type != SDL_FINGERDOWN && rec.type != SDL_FINGERUP && rec.type != SDL_FINGERMOTION)
+		return false;
+
+	int slot = FindFinger(rec.which);
+	if (slot < 0 && rec.type == SDL_FINGERDOWN)
+		slot = AddFinger(rec.which);
+
+	//Lifted already, or every slot is taken
+	if (slot < 0)
+		return true;
+
+	TouchFinger & f = touch_live_[slot];
+	const float x = FromFraction(static_cast<Uint32>(rec.value));
+	const float y = FromFraction(static_cast<Uint32>(rec.value) >> 16);
+
+	//A new finger starts where it lands, with no motion
+	if (touch_.raw.Test(slot) && (x != f.x || y != f.y))
+	{
+		f.dx += x - f.x;
+		f.dy += y - f.y;
+		touch_moved_live_.Set(slot, true);
+	}
+
+	f.x = x;
+	f.y = y;
+	f.pressure = FromFraction(rec.code);
+
+	if (rec.type == SDL_FINGERUP)
+	{
+		touch_.Set(slot, false, rec.counter);
+		RemoveFinger(rec.which);
+	}
+	else
+		touch_.Set(slot, true, rec.counter);
+
+	return true;
+}
+
+int Input::FindFinger(Sint32 id)
+{
+	//The table is never more than half full, probes end at an empty entry
+	for (unsigned i = id & TABLE_MASK;; i = (i + 1) & TABLE_MASK)
+	{
+		const unsigned slot = touch_table_[i];
+
+		if (slot == NO_FINGER)
+			return -1;
+
+		if (touch_ids_[slot] == id)
+			return static_cast<int>(slot);
+	}
+}
+
+int Input::AddFinger(Sint32 id)
+{
+	//Slots of lifted fingers stay taken until Update reports them released
+	const Uint64 taken = touch_.raw.words[0] | touch_.down.words[0];
+
+	unsigned slot = 0;
+	while (slot < INPUT_MAX_FINGERS && (taken >> slot) & 1)
+		++slot;
+
+	if (slot == INPUT_MAX_FINGERS)
+		return -1;
+
+	touch_ids_[slot] = id;
+	std::memset(&touch_live_[slot], 0, sizeof(touch_live_[slot]));
+	touch_moved_live_.Set(slot, false);
+
+	unsigned i = id & TABLE_MASK;
+	while (touch_table_[i] != NO_FINGER)
+		i = (i + 1) & TABLE_MASK;
+
+	touch_table_[i] = static_cast<Uint8>(slot);
+	return static_cast<int>(slot);
+}
+
+void Input::RemoveFinger(Sint32 id)
+{
+	unsigned hole = id & TABLE_MASK;
+	while (touch_ids_[touch_table_[hole]] != id)
+		hole = (hole + 1) & TABLE_MASK;
+
+	//Backward shift deletion, same as the controller table
+	for (unsigned i = (hole + 1) & TABLE_MASK; touch_table_[i] != NO_FINGER; i = (i + 1) & TABLE_MASK)
+	{
+		const unsigned home = touch_ids_[touch_table_[i]] & TABLE_MASK;
+
+		if (((i - home) & TABLE_MASK) >= ((i - hole) & TABLE_MASK))
+		{
+			touch_table_[hole] = touch_table_[i];
+			hole = i;
+		}
+	}
+
+	touch_table_[hole] = NO_FINGER;
+}
+
+void Input::UpdateTouch()
+{
+	touch_.Update();
+
+	std::memcpy(touch_frame_, touch_live_, sizeof(touch_frame_));
+	for (unsigned s = 0; s < INPUT_MAX_FINGERS; ++s)
+		touch_live_[s].dx = touch_live_[s].dy = 0.0f;
+
+	touch_moved_ = touch_moved_live_;
+	touch_moved_live_.Clear();
+
+	if (!touch_gestures_)
+		return;
+
+	TouchGesture & g = touch_gesture_;
+	g.fingers = 0;
+	g.x = g.y = 0.0f;
+	g.pinch = 1.0f;
+	g.rotation = 0.0f;
+
+	//Only fingers held both frames, one landing or lifting would make the
+	//center jump
+	const Uint64 held = touch_.pressed.words[0];
+	float x0 = 0.0f, y0 = 0.0f;
+
+	for (unsigned s = 0; s < INPUT_MAX_FINGERS; ++s)
+	{
+		if (!((held >> s) & 1))
+			continue;
+
+		const TouchFinger & f = touch_frame_[s];
+		g.x += f.x;
+		g.y += f.y;
+		x0 += f.x - f.dx;
+		y0 += f.y - f.dy;
+		++g.fingers;
+	}
+
+	if (g.fingers == 0)
+		return;
+
+	const float n = static_cast<float>(g.fingers);
+	g.x /= n;
+	g.y /= n;
+	x0 /= n;
+	y0 /= n;
+
+	if (g.fingers < 2)
+		return;
+
+	//Spread and angles around the center, in square units
+	float spread = 0.0f, spread0 = 0.0f, turn = 0.0f;
+
+	for (unsigned s = 0; s < INPUT_MAX_FINGERS; ++s)
+	{
+		if (!((held >> s) & 1))
+			continue;
+
+		const TouchFinger & f = touch_frame_[s];
+		const float ax = (f.x - g.x) * touch_aspect_, ay = f.y - g.y;
+		const float bx = (f.x - f.dx - x0) * touch_aspect_, by = f.y - f.dy - y0;
+
+		spread += std::sqrt(ax * ax + ay * ay);
+		spread0 += std::sqrt(bx * bx + by * by);
+
+		float angle = std::atan2(ay, ax) - std::atan2(by, bx);
+		if (angle > PI)
+			angle -= 2.0f * PI;
+		else if (angle < -PI)
+			angle += 2.0f * PI;
+
+		turn += angle;
+	}
+
+	if (spread0 > 0.0f)
+		g.pinch = spread / spread0;
+
+	g.rotation = turn / n;
+}
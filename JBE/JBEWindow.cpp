@@ -2,6 +2,9 @@
 #include "JBEInput.h"
 
 SDL_Window *WindowManager::window_;
+SDL_Event WindowManager::batch_[WINDOW_EVENT_BATCH];
+unsigned WindowManager::budget_ = WINDOW_EVENT_BUDGET;
+WindowManager::EventStats WindowManager::stats_;
 
 bool WindowManager::Initialize(std::string wname, int w, int h, Uint32 f)
 {
@@ -22,13 +25,41 @@ bool WindowManager::Initialize(std::string wname, int w, int h, Uint32 f)
 
 void WindowManager::Update()
 {
-	SDL_Event evt;
-	SDL_PollEvent(&evt);
+	stats_.drained = stats_.batches = stats_.backlog = 0;
 
-	if (evt.type == SDL_QUIT)
-		CleanUp();
+	//Pump once, then only read what is already queued
+	SDL_PumpEvents();
 
-	Input::HandleEvent(&evt);
+	while (stats_.drained < budget_)
+	{
+		unsigned left = budget_ - stats_.drained;
+		int want = static_cast<int>(left < WINDOW_EVENT_BATCH ? left : WINDOW_EVENT_BATCH);
+		int got = SDL_PeepEvents(batch_, want, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+		if (got <= 0)
+			return;
+
+		++stats_.batches;
+		stats_.drained += got;
+
+		for (int i = 0; i < got; ++i)
+		{
+			if (batch_[i].type == SDL_QUIT)
+			{
+				CleanUp();
+				return;
+			}
+
+			Input::HandleEvent(&batch_[i]);
+		}
+
+		if (got < want) //queue is empty
+			return;
+	}
+
+	//Out of budget, peek at what is left so it shows up in the stats
+	int left = SDL_PeepEvents(batch_, WINDOW_EVENT_BATCH, SDL_PEEKEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+	stats_.backlog = (left > 0) ? left : 0;
 }
 
 void WindowManager::CleanUp()
@@ -47,3 +78,13 @@ SDL_Window * WindowManager::GetWindowHandle(void)
 {
 	return window_;
 }
+
+void WindowManager::SetEventBudget(unsigned budget)
+{
+	budget_ = (budget == 0) ? WINDOW_EVENT_BUDGET : budget;
+}
+
+const WindowManager::EventStats & WindowManager::GetEventStats(void)
+{
+	return stats_;
+}
@@ -1,4 +1,6 @@
 #pragma once
+#define WINDOW_EVENT_BATCH 64
+#define WINDOW_EVENT_BUDGET 4096
 
 #include <SDL.h>
 #include <string>
@@ -6,6 +8,19 @@
 class WindowManager
 {
 public:
+	/*************************************************************************************/
+	/*!
+	\brief
+		Counters describing how the event queue was drained during the last Update
+	*/
+	/*************************************************************************************/
+	struct EventStats
+	{
+		unsigned drained;	//events removed from the queue and dispatched
+		unsigned batches;	//calls to SDL_PeepEvents that returned events
+		unsigned backlog;	//events left in the queue (saturates at WINDOW_EVENT_BATCH)
+	};
+
 	/*************************************************************************************/
 	/*!
 	\brief
@@ -26,6 +41,12 @@ public:
 	/*!
 	\brief
 		Polls and forwards window messages
+
+	\detail
+		Pumps the OS event loop once and then drains the SDL event queue in
+		batches of WINDOW_EVENT_BATCH events, forwarding every one of them to
+		Input::HandleEvent. At most 'budget' events are drained per call (see
+		SetEventBudget), whatever is left stays queued for the next frame.
 	*/
 	/*************************************************************************************/
 	static void Update();
@@ -54,6 +75,24 @@ public:
 	/*************************************************************************************/
 	static SDL_Window * GetWindowHandle(void);
 
+	/*************************************************************************************/
+	/*!
+	\brief
+		Sets the maximum number of events drained by a single call to Update
+
+	\param budget	Events per frame, 0 restores the default (WINDOW_EVENT_BUDGET)
+	*/
+	/*************************************************************************************/
+	static void SetEventBudget(unsigned budget);
+
+	/*************************************************************************************/
+	/*!
+	\brief
+		Gets the event queue counters of the last call to Update
+	*/
+	/*************************************************************************************/
+	static const EventStats & GetEventStats(void);
+
 private:
 	/*************************************************************************************/
 	/*!
@@ -62,4 +101,28 @@ private:
 	*/
 	/*************************************************************************************/
 	static SDL_Window * window_;
+
+	/*************************************************************************************/
+	/*!
+	\brief
+		Preallocated storage the event queue is drained into
+	*/
+	/*************************************************************************************/
+	static SDL_Event batch_[WINDOW_EVENT_BATCH];
+
+	/*************************************************************************************/
+	/*!
+	\brief
+		Maximum amount of events drained per Update
+	*/
+	/*************************************************************************************/
+	static unsigned budget_;
+
+	/*************************************************************************************/
+	/*!
+	\brief
+		Counters for the last Update
+	*/
+	/*************************************************************************************/
+	static EventStats stats_;
 };
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+/*
+*	\brief	Times the bitset button states against the char array state
+*			machine they replaced, over the same keyboard, mouse and
+*			INPUT_MAX_CONTROLLERS pads, on idle frames and on frames with
+*			key changes. The whole Input::Update is timed on its own, as
+*			nothing before it did the same work.
+*
+*	\param	frames	Amount of frames simulated per measurement
+*/
+void BenchInputUpdate(unsigned frames);
+
+/*
+*	\brief	Pushes 'frames' frames of 'per_frame' synthetic events (keys,
+*			mouse, pad buttons and axes) through Input::HandleEvent and
+*			Update, in immediate and in deferred mode, and reports events
+*			per second, ns per frame and, on Linux, cache misses per
+*			frame. A pad is unplugged and plugged again every 64 frames,
+*			between frames and outside the measured time.
+*
+*	\detail	Needs no window or device. On Linux, from the JBE folder,
+*			build the .cpp files in bench/ with the ..\ sources
+*			JBEBench.vcxproj lists:
+*			<li>
+*			g++ -O2 -std=c++14 -I. -Iinclude -pthread <those files> -lSDL2
+*			</li>
+*			BenchMain asks SDL for its dummy video driver when none is
+*			set. Run that way against SDL 2.28 with the 2.0.3 headers in
+*			include/. Cache misses come from perf_event_open, which may
+*			need kernel.perf_event_paranoid lowered.
+*/
+void BenchInputFlood(unsigned frames, unsigned per_frame);
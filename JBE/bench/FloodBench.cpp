@@ -0,0 +1,261 @@
+#include "Bench.h"
+#include "JBEInput.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	const unsigned PADS = INPUT_MAX_CONTROLLERS;
+	const SDL_JoystickID FIRST_PAD_ID = 1000;
+	const unsigned PLUG_PERIOD = 64;	//frames between hot-plugs
+	const unsigned SCRIPT_FRAMES = 256;	//frames of events generated up front
+
+	//Keeps the compiler from throwing the measured work away
+	volatile unsigned sink;
+
+	/*
+	*	\brief	Hardware cache miss counter of this thread, only on Linux
+	*			(perf_event_open). Reads 0 everywhere else, or when the
+	*			kernel does not allow it.
+	*/
+	class CacheMisses
+	{
+	public:
+		CacheMisses() : fd_(-1)
+		{
+#ifdef __linux__
+			perf_event_attr attr;
+			std::memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_CACHE_MISSES;
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+
+			fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+		}
+
+		~CacheMisses()
+		{
+#ifdef __linux__
+			if (fd_ >= 0)
+				close(fd_);
+#endif
+		}
+
+		bool IsAvailable() const
+		{
+			return fd_ >= 0;
+		}
+
+		void Start()
+		{
+#ifdef __linux__
+			if (fd_ >= 0)
+			{
+				ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+				ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+			}
+#endif
+		}
+
+		Uint64 Stop()
+		{
+			Uint64 count = 0;
+#ifdef __linux__
+			if (fd_ >= 0)
+			{
+				ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+				if (read(fd_, &count, sizeof(count)) != sizeof(count))
+					count = 0;
+			}
+#endif
+			return count;
+		}
+
+	private:
+		int fd_;
+	};
+
+	/*
+	*	\brief	Same numbers every run, so runs can be compared
+	*/
+	Uint32 Random(Uint32 & seed)
+	{
+		seed = seed * 1664525u + 1013904225u;
+		return seed >> 8;
+	}
+
+	/*
+	*	\brief	Fills 'script' with SCRIPT_FRAMES frames of 'per_frame'
+	*			events each: keys, mouse motion and clicks, pad buttons
+	*			and, mostly, pad axes, the way a busy session sends them.
+	*/
+	void MakeScript(std::vector<SDL_Event> & script, unsigned per_frame)
+	{
+		script.assign(SCRIPT_FRAMES * per_frame, SDL_Event());
+
+		bool keys[SDL_NUM_SCANCODES] = { false };
+		bool buttons[PADS][SDL_CONTROLLER_BUTTON_MAX] = { { false } };
+		Uint32 seed = 12345;
+
+		for (unsigned i = 0; i < script.size(); ++i)
+		{
+			SDL_Event & ev = script[i];
+			std::memset(&ev, 0, sizeof(ev));
+
+			const Uint32 kind = Random(seed) % 16;
+			const unsigned pad = Random(seed) % PADS;
+
+			if (kind < 2)
+			{
+				const SDL_Scancode sc = static_cast<SDL_Scancode>(SDL_SCANCODE_A + Random(seed) % 64);
+				keys[sc] = !keys[sc];
+				ev.type = keys[sc] ? SDL_KEYDOWN : SDL_KEYUP;
+				ev.key.keysym.scancode = sc;
+			}
+			else if (kind < 5)
+			{
+				ev.type = SDL_MOUSEMOTION;
+				ev.motion.x = static_cast<Sint32>(Random(seed) % 1920);
+				ev.motion.y = static_cast<Sint32>(Random(seed) % 1080);
+				ev.motion.xrel = static_cast<Sint32>(Random(seed) % 9) - 4;
+				ev.motion.yrel = static_cast<Sint32>(Random(seed) % 9) - 4;
+			}
+			else if (kind < 6)
+			{
+				ev.type = (Random(seed) & 1) ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+				ev.button.button = static_cast<Uint8>(1 + Random(seed) % Input::MOUSE_NUMBTNS);
+			}
+			else if (kind < 8)
+			{
+				const unsigned btn = Random(seed) % SDL_CONTROLLER_BUTTON_MAX;
+				buttons[pad][btn] = !buttons[pad][btn];
+				ev.type = buttons[pad][btn] ? SDL_CONTROLLERBUTTONDOWN : SDL_CONTROLLERBUTTONUP;
+				ev.cbutton.which = FIRST_PAD_ID + pad;
+				ev.cbutton.button = static_cast<Uint8>(btn);
+			}
+			else
+			{
+				ev.type = SDL_CONTROLLERAXISMOTION;
+				ev.caxis.which = FIRST_PAD_ID + pad;
+				ev.caxis.axis = static_cast<Uint8>(Random(seed) % SDL_CONTROLLER_AXIS_MAX);
+				ev.caxis.value = static_cast<Sint16>(Random(seed) & 0xFFFF);
+			}
+		}
+	}
+
+	/*
+	*	\brief	Plugs the pad 'pad' in or out. There is no device behind it
+	*			for SDL to open, so the records are injected directly,
+	*			which also skips the deferred queue. Only called between
+	*			frames, outside the measured time.
+	*/
+	void PlugPad(unsigned pad, bool plugged)
+	{
+		Input::Record rec;
+		std::memset(&rec, 0, sizeof(rec));
+		rec.type = static_cast<Uint16>(plugged ? SDL_CONTROLLERDEVICEADDED : SDL_CONTROLLERDEVICEREMOVED);
+		rec.which = FIRST_PAD_ID + pad;
+
+		Input::InjectRecord(rec);
+	}
+
+	struct FloodResult
+	{
+		double events_per_second;	//HandleEvent throughput
+		double update_ns;			//Update, per frame
+		double frame_ns;			//HandleEvent and Update, per frame
+		double misses;				//cache misses, per frame
+	};
+
+	FloodResult RunFlood(std::vector<SDL_Event> & script, unsigned frames, unsigned per_frame, bool deferred)
+	{
+		Input::Init();
+		Input::SetDeferred(deferred);
+
+		for (unsigned pad = 0; pad < PADS; ++pad)
+			PlugPad(pad, true);
+
+		CacheMisses counter;
+		const Uint64 freq = SDL_GetPerformanceFrequency();
+		Uint64 handle_ticks = 0, update_ticks = 0;
+		unsigned hits = 0;
+
+		counter.Start();
+		for (unsigned f = 0; f < frames; ++f)
+		{
+			SDL_Event * events = &script[(f % SCRIPT_FRAMES) * per_frame];
+
+			if (f % PLUG_PERIOD == PLUG_PERIOD - 1)
+			{
+				PlugPad(f % PADS, false);
+				PlugPad(f % PADS, true);
+			}
+
+			const Uint64 t0 = SDL_GetPerformanceCounter();
+
+			for (unsigned e = 0; e < per_frame; ++e)
+				Input::HandleEvent(&events[e]);
+
+			const Uint64 t1 = SDL_GetPerformanceCounter();
+			Input::Update();
+			const Uint64 t2 = SDL_GetPerformanceCounter();
+
+			handle_ticks += t1 - t0;
+			update_ticks += t2 - t1;
+			hits += Input::IsKeyTriggered(SDL_SCANCODE_A) + Input::IsGamePadPressed(0, SDL_CONTROLLER_BUTTON_A);
+		}
+		const Uint64 misses = counter.Stop();
+
+		Input::SetDeferred(false);
+		sink = hits + Input::GetDroppedRecords();
+
+		const double events = static_cast<double>(frames) * per_frame;
+		FloodResult r;
+		r.events_per_second = (handle_ticks != 0) ? events * freq / handle_ticks : 0.0;
+		r.update_ns = static_cast<double>(update_ticks) * 1e9 / freq / frames;
+		r.frame_ns = static_cast<double>(handle_ticks + update_ticks) * 1e9 / freq / frames;
+		r.misses = static_cast<double>(misses) / frames;
+		return r;
+	}
+}
+
+void BenchInputFlood(unsigned frames, unsigned per_frame)
+{
+	//The deferred queue has to hold a whole frame
+	if (per_frame > INPUT_QUEUE_SIZE)
+		per_frame = INPUT_QUEUE_SIZE;
+
+	std::vector<SDL_Event> script;
+	MakeScript(script, per_frame);
+
+	std::printf("Input::HandleEvent flood, %u frames of %u events\n", frames, per_frame);
+
+	const bool cache = CacheMisses().IsAvailable();
+	const char * modes[2] = { "immediate", "deferred" };
+
+	for (unsigned deferred = 0; deferred < 2; ++deferred)
+	{
+		FloodResult r = RunFlood(script, frames, per_frame, deferred != 0);
+
+		std::printf("  %-9s: %7.2f M events/s, Update %8.1f ns/frame, total %9.1f ns/frame, ",
+			modes[deferred], r.events_per_second / 1e6, r.update_ns, r.frame_ns);
+
+		if (cache)
+			std::printf("%8.1f cache misses/frame\n", r.misses);
+		else
+			std::printf("cache misses n/a\n");
+	}
+}
@@ -0,0 +1,194 @@
+#include "Bench.h"
+#include "JBEInput.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	/*
+	*	\brief	The per byte, four way branch state machine Input::Update
+	*			used before the bitsets. Kept only as the baseline.
+	*/
+	struct LegacyInput
+	{
+		char kb_prev[SDL_NUM_SCANCODES];
+		char kb_curr[SDL_NUM_SCANCODES];
+		char m_prev[Input::MOUSE_NUMBTNS + 1];
+		char m_curr[Input::MOUSE_NUMBTNS + 1];
+		char gp_prev[INPUT_MAX_CONTROLLERS][SDL_CONTROLLER_BUTTON_MAX];
+		char gp_curr[INPUT_MAX_CONTROLLERS][SDL_CONTROLLER_BUTTON_MAX];
+
+		static void Step(char & prev, char & curr)
+		{
+			if (prev == 0 && curr == 1)
+				prev = 1;
+			else if (prev == 1 && curr == 1)
+				curr = 2;
+			else if (prev != 0 && curr == 0)
+			{
+				curr = 3;
+				prev = 0;
+			}
+			else if (curr == 3)
+				curr = 0;
+		}
+
+		void Update()
+		{
+			for (unsigned i = 0; i < SDL_NUM_SCANCODES; ++i)
+				Step(kb_prev[i], kb_curr[i]);
+
+			for (unsigned i = 0; i <= Input::MOUSE_NUMBTNS; ++i)
+				Step(m_prev[i], m_curr[i]);
+
+			for (unsigned c = 0; c < INPUT_MAX_CONTROLLERS; ++c)
+			for (unsigned i = 0; i < SDL_CONTROLLER_BUTTON_MAX; ++i)
+				Step(gp_prev[c][i], gp_curr[c][i]);
+		}
+	};
+
+	/*
+	*	\brief	The same devices as LegacyInput, with the bitset state
+	*			machine Input::Update runs for them now
+	*/
+	struct BitsetInput
+	{
+		ButtonStates<SDL_NUM_SCANCODES> kb;
+		ButtonStates<Input::MOUSE_NUMBTNS + 1> m;
+		ButtonStates<SDL_CONTROLLER_BUTTON_MAX> gp[INPUT_MAX_CONTROLLERS];
+
+		void Clear()
+		{
+			kb.Clear();
+			m.Clear();
+
+			for (unsigned c = 0; c < INPUT_MAX_CONTROLLERS; ++c)
+				gp[c].Clear();
+		}
+
+		void Update()
+		{
+			kb.Update();
+			m.Update();
+
+			for (unsigned c = 0; c < INPUT_MAX_CONTROLLERS; ++c)
+				gp[c].Update();
+		}
+	};
+
+	LegacyInput legacy;
+	BitsetInput bitset;
+
+	//Keeps the compiler from throwing the measured work away
+	volatile unsigned sink;
+
+	double NsPerFrame(Uint64 start, Uint64 end, unsigned frames)
+	{
+		return static_cast<double>(end - start) * 1e9 /
+			static_cast<double>(SDL_GetPerformanceFrequency()) / frames;
+	}
+
+	/*
+	*	\brief	Key toggled on frame 'f', or SDL_SCANCODE_UNKNOWN on idle frames
+	*/
+	SDL_Scancode KeyForFrame(unsigned f, bool busy)
+	{
+		if (!busy)
+			return SDL_SCANCODE_UNKNOWN;
+
+		return static_cast<SDL_Scancode>(SDL_SCANCODE_A + (f % 26));
+	}
+
+	double RunLegacy(unsigned frames, bool busy)
+	{
+		std::memset(&legacy, 0, sizeof(legacy));
+		unsigned hits = 0;
+
+		Uint64 start = SDL_GetPerformanceCounter();
+		for (unsigned f = 0; f < frames; ++f)
+		{
+			SDL_Scancode sc = KeyForFrame(f, busy);
+			if (sc != SDL_SCANCODE_UNKNOWN)
+				legacy.kb_curr[sc] = (legacy.kb_curr[sc] == 0) ? 1 : 0;
+
+			legacy.Update();
+			hits += (legacy.kb_curr[SDL_SCANCODE_A] == 1);
+		}
+		Uint64 end = SDL_GetPerformanceCounter();
+
+		sink = hits;
+		return NsPerFrame(start, end, frames);
+	}
+
+	double RunBitset(unsigned frames, bool busy)
+	{
+		bitset.Clear();
+		unsigned hits = 0;
+
+		Uint64 start = SDL_GetPerformanceCounter();
+		for (unsigned f = 0; f < frames; ++f)
+		{
+			SDL_Scancode sc = KeyForFrame(f, busy);
+			if (sc != SDL_SCANCODE_UNKNOWN)
+				bitset.kb.Set(sc, !bitset.kb.raw.Test(sc), f);
+
+			bitset.Update();
+			hits += bitset.kb.triggered.Test(SDL_SCANCODE_A);
+		}
+		Uint64 end = SDL_GetPerformanceCounter();
+
+		sink = hits;
+		return NsPerFrame(start, end, frames);
+	}
+
+	double RunInput(unsigned frames, bool busy)
+	{
+		Input::Init();
+		unsigned hits = 0;
+
+		SDL_Event ev;
+		std::memset(&ev, 0, sizeof(ev));
+
+		Uint64 start = SDL_GetPerformanceCounter();
+		for (unsigned f = 0; f < frames; ++f)
+		{
+			SDL_Scancode sc = KeyForFrame(f, busy);
+			if (sc != SDL_SCANCODE_UNKNOWN)
+			{
+				ev.type = Input::IsKeyPressed(sc) ? SDL_KEYUP : SDL_KEYDOWN;
+				ev.key.keysym.scancode = sc;
+				Input::HandleEvent(&ev);
+			}
+
+			Input::Update();
+			hits += Input::IsKeyTriggered(SDL_SCANCODE_A);
+		}
+		Uint64 end = SDL_GetPerformanceCounter();
+
+		sink = hits;
+		return NsPerFrame(start, end, frames);
+	}
+}
+
+void BenchInputUpdate(unsigned frames)
+{
+	const char * names[2] = { "idle", "busy" };
+
+	std::printf("Button state step, keyboard, mouse and %u pads, %u frames\n", INPUT_MAX_CONTROLLERS, frames);
+
+	for (unsigned busy = 0; busy < 2; ++busy)
+	{
+		double old_ns = RunLegacy(frames, busy != 0);
+		double new_ns = RunBitset(frames, busy != 0);
+
+		std::printf("  %s: char arrays %8.1f ns/frame, ButtonStates %8.1f ns/frame (%.1fx)\n",
+			names[busy], old_ns, new_ns, old_ns / new_ns);
+	}
+
+	//Everything else Update does has no legacy counterpart, so no ratio
+	std::printf("Whole Input::Update, every device and layer, no controllers, %u frames\n", frames);
+
+	for (unsigned busy = 0; busy < 2; ++busy)
+		std::printf("  %s: %8.1f ns/frame\n", names[busy], RunInput(frames, busy != 0));
+}
@@ -1,4 +1,7 @@
 #include "JBEWindow.h"
+#include "JBEConfig.h"
+#include "JBEFramePacer.h"
+#include "JBEHaptics.h"
 #include "JBEInput.h"
 
 #include <iostream>
@@ -12,28 +15,65 @@ extern "C" FILE * __cdecl __iob_func(void)
 
 int main(int argc, char* args[])
 {
-	WindowManager::Initialize("Engine test", 1280, 720);
+	Config settings;
+	settings.Open("settings.jbc");
+
+	WindowManager::Initialize("Engine test",
+		settings.GetInt(CONFIG_KEY("video.width"), 1280),
+		settings.GetInt(CONFIG_KEY("video.height"), 720));
 	Input::Init();
+	Haptics::Init();
+	FramePacer::Init(settings.GetFloat(CONFIG_KEY("video.fps"), static_cast<float>(FRAME_PACER_RATE)));
+
+	const Input::ActionID toggle_fs = INPUT_ACTION("ToggleFullscreen");
+	const Input::ActionID quit_game = INPUT_ACTION("Quit");
 
 	bool quit = false;
 	bool fs = false;
 
+	//Subscribed before the bindings are loaded, LoadBindings keeps it
+	Input::SubscribeAction(quit_game, [&quit](const Input::InputEvent & e)
+	{
+		if (e.down)
+			quit = true;
+	});
+
+	if (!Input::LoadBindings(settings))
+	{
+		Input::BindKey(toggle_fs, SDL_SCANCODE_F);
+		Input::BindGamePadButton(toggle_fs, SDL_CONTROLLER_BUTTON_X);
+		Input::BindKey(quit_game, SDL_SCANCODE_Q);
+		Input::BindGamePadButton(quit_game, SDL_CONTROLLER_BUTTON_Y);
+	}
+
+	settings.Close();
+	Input::SetJoinOnPress(true);
+
 	while (!quit)
 	{
 		WindowManager::Update();
+		Haptics::Flush();
 		Input::Update();
 
-		if (Input::IsKeyTriggered(SDL_SCANCODE_F) || Input::IsGamePadTriggered(0, SDL_GameControllerButton::SDL_CONTROLLER_BUTTON_X))
+		//Greet whoever just joined
+		for (unsigned p = 0; p < INPUT_MAX_PLAYERS; ++p)
+			if (Input::HasPlayerJoined(p) && Input::GetPlayerController(p) >= 0)
+				Haptics::Rumble(Input::GetPlayerController(p), 0.5f, 200);
+
+		if (Input::IsActionTriggered(toggle_fs))
 		{
 			fs = !fs;
 			WindowManager::SetFullscreen(fs);
 		}
 
-
-		if (Input::IsKeyTriggered(SDL_SCANCODE_Q) || Input::IsGamePadTriggered(0, SDL_GameControllerButton::SDL_CONTROLLER_BUTTON_Y))
-			quit = true;
+		FramePacer::Wait();
 	}
 
+	const FramePacer::Stats & pacing = FramePacer::GetStats();
+	std::cout << "Frame time " << pacing.mean * 1000.0 << " ms, jitter " << pacing.jitter * 1000.0
+		<< " ms, " << pacing.late << " late of " << pacing.frames << std::endl;
+
+	Haptics::Shutdown();
 	WindowManager::CleanUp();
 
 	return 0;